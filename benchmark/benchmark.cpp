@@ -0,0 +1,290 @@
+//=====[Libraries]=============================================================
+
+#include "mbed.h"
+#include "arm_book_lib.h"
+
+#include "moving_average.h"
+#include "sensor_registry.h"
+#include "pc_serial_com.h"
+#include "task_timing.h"
+#include "text_format.h"
+#include "alarm_config.h"
+
+// Solo se compila con benchmark/benchmark_app.json; en la compilacion normal
+// este archivo queda vacio.
+#ifdef BENCHMARK_BUILD
+
+//=====[Declaration of private defines]========================================
+
+#define BENCHMARK_ITERATIONS               1000
+#define BENCHMARK_FORMAT_ITERATIONS         100
+#define BENCHMARK_UART_MESSAGE_LENGTH        64
+#define BENCHMARK_UART_MESSAGES              16   // Entran juntos en el buffer de TX
+#define BENCHMARK_IDLE_POLL_MS               10
+
+//=====[Declaration of private data types]=====================================
+
+typedef void (*benchmarkKernel_t)( uint32_t iterations );
+
+typedef struct {
+    const char* name;
+    uint32_t iterations;
+    benchmarkKernel_t kernel;
+} benchmark_t;
+
+//=====[Declarations (prototypes) of functions implemented in main.cpp]========
+
+int analogReadingScaledWithTheLM35Formula( uint16_t analogReading );
+int celsiusToFahrenheit( int tempInCelsiusDegrees );
+bool areEqual( uint32_t code );
+
+//=====[Declarations (prototypes) of private functions]========================
+
+static void benchmarkEmptyKernel( uint32_t iterations );
+static void benchmarkMovingAverageKernel( uint32_t iterations );
+static void benchmarkSensorRegistryKernel( uint32_t iterations );
+static void benchmarkLm35ScaleKernel( uint32_t iterations );
+static void benchmarkFahrenheitKernel( uint32_t iterations );
+static void benchmarkAreEqualKernel( uint32_t iterations );
+static void benchmarkSprintfKernel( uint32_t iterations );
+static void benchmarkTextFormatKernel( uint32_t iterations );
+static void benchmarkUartWriteKernel( uint32_t iterations );
+
+static uint32_t benchmarkRun( const benchmark_t* benchmark );
+static void benchmarkSuiteRun();
+static void benchmarkResultWrite( const benchmark_t* benchmark, uint32_t cycles );
+static void benchmarkTxIdleWait();
+
+//=====[Declaration and initialization of private global variables]============
+
+// Entradas y salidas volatiles para que el compilador no elimine los lazos
+static volatile uint32_t benchmarkInput = 0x1234;
+static volatile int benchmarkSink = 0;
+
+static uint16_t benchmarkFilterArray[alarmConfig::numberOfAvgSamples];
+static movingAverage_t benchmarkFilter;
+
+static const benchmark_t benchmarks[] = {
+    { "moving_average_update", BENCHMARK_ITERATIONS,        benchmarkMovingAverageKernel },
+    { "sensor_registry_sample", BENCHMARK_ITERATIONS,       benchmarkSensorRegistryKernel },
+    { "lm35_scale",            BENCHMARK_ITERATIONS,        benchmarkLm35ScaleKernel },
+    { "celsius_to_fahrenheit", BENCHMARK_ITERATIONS,        benchmarkFahrenheitKernel },
+    { "are_equal",             BENCHMARK_ITERATIONS,        benchmarkAreEqualKernel },
+    { "sprintf_temperature",   BENCHMARK_FORMAT_ITERATIONS, benchmarkSprintfKernel },
+    { "format_temperature",    BENCHMARK_FORMAT_ITERATIONS, benchmarkTextFormatKernel },
+    { "uart_write_bytes",      BENCHMARK_UART_MESSAGE_LENGTH * BENCHMARK_UART_MESSAGES,
+                               benchmarkUartWriteKernel },
+};
+
+#define BENCHMARK_NUMBER_OF_BENCHMARKS    ( sizeof( benchmarks ) / sizeof( benchmarks[0] ) )
+
+//=====[Main function, the program entry point after power on or reset]========
+
+// Corre la serie completa al arrancar y otra vez cada vez que llega un
+// caracter por la consola.
+int main()
+{
+    char receivedChar;
+
+    taskTimingInit();   //Habilita el contador de ciclos DWT
+    movingAverageInit( &benchmarkFilter, benchmarkFilterArray,
+                       alarmConfig::numberOfAvgSamples );
+    pcSerialComInit( NULL );
+
+    while ( true ) {
+        benchmarkSuiteRun();
+        while ( !pcSerialComCharRead( &receivedChar ) ) {
+            ThisThread::sleep_for( std::chrono::milliseconds( BENCHMARK_IDLE_POLL_MS ) );
+        }
+    }
+}
+
+//=====[Implementations of private functions]==================================
+
+// Formato de salida, una linea por resultado:
+//   BENCH,<nombre>,<iteraciones>,<ciclos totales>,<ciclos por iteracion>
+// Los ciclos ya descuentan el costo del lazo vacio, salvo en la UART,
+// que incluye la transmision completa y el tiempo de interrupcion.
+static void benchmarkSuiteRun()
+{
+    static const benchmark_t emptyBenchmark =
+        { "loop_overhead", BENCHMARK_ITERATIONS, benchmarkEmptyKernel };
+
+    uint32_t overheadCycles;
+    uint32_t cycles;
+    uint32_t i;
+
+    benchmarkTxIdleWait();
+    pcSerialComMessageBegin();
+    pcSerialComMessageString( "BENCH_BEGIN," );
+    pcSerialComMessageUnsigned( SystemCoreClock );
+    pcSerialComMessageString( "\r\n" );
+    pcSerialComMessageEnd();
+
+    overheadCycles = benchmarkRun( &emptyBenchmark );
+    benchmarkResultWrite( &emptyBenchmark, overheadCycles );
+
+    for ( i = 0; i < BENCHMARK_NUMBER_OF_BENCHMARKS; i++ ) {
+        cycles = benchmarkRun( &benchmarks[i] );
+        if ( benchmarks[i].kernel != benchmarkUartWriteKernel ) {
+            uint32_t scaledOverhead = (uint32_t) ( (uint64_t) overheadCycles *
+                                      benchmarks[i].iterations / emptyBenchmark.iterations );
+            cycles = cycles > scaledOverhead ? cycles - scaledOverhead : 0;
+        }
+        benchmarkResultWrite( &benchmarks[i], cycles );
+    }
+
+    pcSerialComMessageBegin();
+    pcSerialComMessageString( "BENCH_END," );
+    pcSerialComMessageUnsigned( pcSerialComTxDroppedMessages() );
+    pcSerialComMessageString( "\r\n" );
+    pcSerialComMessageEnd();
+}
+
+static void benchmarkResultWrite( const benchmark_t* benchmark, uint32_t cycles )
+{
+    pcSerialComMessageBegin();
+    pcSerialComMessageString( "BENCH," );
+    pcSerialComMessageString( benchmark->name );
+    pcSerialComMessageString( "," );
+    pcSerialComMessageUnsigned( benchmark->iterations );
+    pcSerialComMessageString( "," );
+    pcSerialComMessageUnsigned( cycles );
+    pcSerialComMessageString( "," );
+    pcSerialComMessageUnsigned( cycles / benchmark->iterations );
+    pcSerialComMessageString( "\r\n" );
+    pcSerialComMessageEnd();
+}
+
+// Espera a que la UART termine de transmitir para que la interrupcion de TX
+// no se cuente dentro de la medicion.
+static uint32_t benchmarkRun( const benchmark_t* benchmark )
+{
+    uint32_t startCycles;
+
+    benchmarkTxIdleWait();
+
+    startCycles = taskTimingStart();
+    benchmark->kernel( benchmark->iterations );
+    return taskTimingStart() - startCycles;
+}
+
+static void benchmarkTxIdleWait()
+{
+    while ( !pcSerialComTxIdle() ) {
+        ThisThread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+}
+
+static void benchmarkEmptyKernel( uint32_t iterations )
+{
+    uint32_t i;
+
+    for ( i = 0; i < iterations; i++ ) {
+        benchmarkSink = benchmarkInput;
+    }
+}
+
+static void benchmarkMovingAverageKernel( uint32_t iterations )
+{
+    uint32_t i;
+
+    for ( i = 0; i < iterations; i++ ) {
+        benchmarkSink = movingAverageUpdate( &benchmarkFilter, (uint16_t) benchmarkInput );
+    }
+}
+
+// Una muestra con todos los canales de la placa: promedios y ultimas lecturas
+static void benchmarkSensorRegistryKernel( uint32_t iterations )
+{
+    adcSample_t sample;
+    uint32_t i;
+
+    memset( &sample, 0, sizeof( sample ) );
+    for ( i = 0; i < iterations; i++ ) {
+        sample.analog[0] = (uint16_t) benchmarkInput;
+        sensorRegistrySampleWrite( &sample );
+    }
+    benchmarkSink = sensorRegistryAverageRead( SENSOR_CHANNEL_ZONE1_TEMPERATURE );
+}
+
+static void benchmarkLm35ScaleKernel( uint32_t iterations )
+{
+    uint32_t i;
+
+    for ( i = 0; i < iterations; i++ ) {
+        benchmarkSink = analogReadingScaledWithTheLM35Formula( (uint16_t) benchmarkInput );
+    }
+}
+
+static void benchmarkFahrenheitKernel( uint32_t iterations )
+{
+    uint32_t i;
+
+    for ( i = 0; i < iterations; i++ ) {
+        benchmarkSink = celsiusToFahrenheit( (int) benchmarkInput );
+    }
+}
+
+static void benchmarkAreEqualKernel( uint32_t iterations )
+{
+    uint32_t i;
+
+    for ( i = 0; i < iterations; i++ ) {
+        benchmarkSink = areEqual( benchmarkInput );
+    }
+}
+
+// La misma respuesta que el comando 'c' de la consola, con el printf que
+// se usaba antes de text_format
+static void benchmarkSprintfKernel( uint32_t iterations )
+{
+    char str[100];
+    uint32_t i;
+    int tempC;
+
+    for ( i = 0; i < iterations; i++ ) {
+        tempC = (int) benchmarkInput;
+        benchmarkSink = sprintf ( str, "Temperature: %d.%02d \xB0 C\r\n",
+                                  tempC / 100, tempC % 100 );
+    }
+}
+
+// La respuesta del comando 'c' tal como la arma hoy la consola
+static void benchmarkTextFormatKernel( uint32_t iterations )
+{
+    static const char prefix[] = "Temperature: ";
+    static const char suffix[] = " \xB0 C\r\n";
+    char str[100];
+    uint32_t i;
+    int length;
+
+    for ( i = 0; i < iterations; i++ ) {
+        memcpy( str, prefix, sizeof( prefix ) - 1 );
+        length = sizeof( prefix ) - 1;
+        length += textFormatCentesimal( &str[length], (int32_t) benchmarkInput );
+        memcpy( &str[length], suffix, sizeof( suffix ) );
+        benchmarkSink = length + sizeof( suffix ) - 1;
+    }
+}
+
+// Iteraciones en bytes: mide desde el primer encolado hasta que el ultimo
+// byte sale del buffer, es decir el throughput real a PC_SERIAL_COM_BAUD_RATE.
+static void benchmarkUartWriteKernel( uint32_t iterations )
+{
+    char message[BENCHMARK_UART_MESSAGE_LENGTH];
+    uint32_t bytesWritten = 0;
+
+    memset( message, 'U', sizeof( message ) - 2 );
+    message[sizeof( message ) - 2] = '\r';
+    message[sizeof( message ) - 1] = '\n';
+
+    while ( bytesWritten < iterations ) {
+        pcSerialComWrite( message, sizeof( message ) );
+        bytesWritten += sizeof( message );
+    }
+    while ( !pcSerialComTxIdle() ) {
+    }
+}
+
+#endif // BENCHMARK_BUILD
@@ -30,381 +30,1446 @@
 
 #include "mbed.h"
 #include "arm_book_lib.h"
+#include "adc_sampler.h"
+#include "sensor_registry.h"
+#include "scheduler.h"
+#include "pc_serial_com.h"
+#include "telemetry.h"
+#include "buttons.h"
+#include "alarm_config.h"
+#include "alarm_output.h"
+#include "alarm_fsm.h"
+#include "spsc_queue.h"
+#include "seqlock.h"
+#include "power_monitor.h"
+#include "task_timing.h"
+#include "task_supervisor.h"
+#include "net_telemetry.h"
+#include "alarm_latency.h"
+#include "flash_log.h"
+#include "sensor_stream.h"
+#include "config_store.h"
+#include "console_command.h"
 #include <string.h>
 
 //=====[Defines]===============================================================
 
-#define NUMBER_OF_KEYS                           4
-#define BLINKING_TIME_GAS_ALARM               1000
-#define BLINKING_TIME_OVER_TEMP_ALARM          500
-#define BLINKING_TIME_GAS_AND_OVER_TEMP_ALARM  100
-#define NUMBER_OF_AVG_SAMPLES                   100
-#define OVER_TEMP_LEVEL                         50
-#define TIME_INCREMENT_MS                       10
+// Umbrales, tiempos de parpadeo y tamaños salen del perfil elegido en
+// alarm_config.h ("alarm-profile" en mbed_app.json)
+#define CODE_SEQUENCE_MASK                     ( ( 1UL << alarmConfig::numberOfKeys ) - 1 )
+#define ADC_BATCH_SIZE                          32
+#define STATUS_QUEUE_SIZE                       16
+#define ADC_FULL_SCALE                       65535 // Lecturas read_u16()
+#define LM35_CENTI_DEGREES_FULL_SCALE        33000 // 3.3 V / 10 mV/°C, en centesimas de grado
+// Mayor lectura cruda que no supera centiDegrees, la inversa de
+// analogReadingScaledWithTheLM35Formula(): los umbrales se comparan sin escalar
+#define LM35_READING( centiDegrees )         ( ( ( ( centiDegrees ) + 1 ) * ADC_FULL_SCALE - \
+                                                 ADC_FULL_SCALE / 2 - 1 ) / \
+                                               LM35_CENTI_DEGREES_FULL_SCALE )
+#define TIME_INCREMENT_MS                       10 // Periodo de las tareas de control
+#define CONSOLE_HEARTBEAT_PERIOD_MS            100 // Prueba de vida del hilo de consola
+// Plazos del supervisor entre dos ejecuciones de cada tarea, con margen
+// sobre su periodo. Todos deben quedar bien por debajo del timeout del
+// watchdog ("watchdog-timeout-ms" en mbed_app.json).
+#define SENSORS_DEADLINE_MS                    100
+#define ALARM_DEADLINE_MS                      100
+#define CONSOLE_DEADLINE_MS                   1000
+#define TELEMETRY_DEADLINE_MS                 2000 // Incluye grabaciones en flash
 
-//=====[Declaration and initialization of public global objects]===============
+//=====[Declaration of public data types]======================================
 
+typedef enum {
+    UART_MODE_COMMANDS,         // Comandos de una tecla o de linea, ver console_command.h
+    UART_MODE_GET_CODE,         // Comando '4': recibiendo el codigo a verificar
+    UART_MODE_SAVE_NEW_CODE,    // Comando '5': recibiendo el codigo nuevo
+    UART_MODE_STREAM_CHANNELS,  // Comando 'b': recibiendo la mascara de canales
+    UART_MODE_OVER_TEMP_LEVEL,  // Comando 'o': recibiendo la temperatura maxima
+} uartMode_t;
 
+// Lecturas y detectores que publica el hilo de alarma tras cada lote de
+// muestras. La consola y el log leen una copia coherente con seqlockRead(),
+// sin tocar el ADC ni el registro.
+typedef struct {
+    uint32_t cycles;                                // Instante de la publicacion
+    uint16_t values[SENSOR_NUMBER_OF_CHANNELS];     // Ver sensorRegistryRead()
+    int32_t rises[SENSOR_NUMBER_OF_CHANNELS];       // Ver sensorRegistryRiseRead()
+    uint32_t activeChannels;
+    int32_t temperatureCentiC;                      // Zona 1
+    bool gasDetector;
+    bool overTempDetector;
+} sensorSnapshot_t;
 
-BusIn buttons(BUTTON1, D2, D4, D5, D6, D7); // Botones Enter (BUTTON1), Test(D2), A (D4), B (D5), C (D6), D (D7)
+// Valor que informa el comando de linea "get". El primer caracter de units
+// es la unidad por defecto; '\0' si el valor no tiene unidades.
+typedef struct {
+    const char* name;
+    const char* units;
+    void (*write)( const sensorSnapshot_t* snapshot, char unit );
+} consoleValue_t;
 
-DigitalIn mq2(PE_12);
+// Parametro del comando de linea "set". write retorna NULL si se aplico o
+// el motivo del rechazo.
+typedef struct {
+    const char* name;
+    const char* (*write)( const char* value );
+} consoleSetting_t;
 
-BusOut leds(LED1, LED3, LED2); // Led de Alarma, Led de Incorrecto, Led de Sistema Bloqueado
+//=====[Declaration and initialization of public global variables]=============
 
+volatile bool alarmFsmTaskPending = false;
+volatile bool digitalEdgeTaskPending = false;
 
-DigitalInOut sirenPin(PE_10);
+bool incorrectCode = false;
+bool overTempDetector = OFF;   // Alguna zona supera la temperatura maxima
+bool gasDetector = OFF;        // Algun MQ-2 detecta gas
 
-UnbufferedSerial uartUsb(USBTX, USBRX, 115200);
+uint32_t buttonsState = 0; // Un bit por boton, ver BUTTON_MASK()
+volatile bool buttonsTaskPending = false;
+int buttonsTimingProbe = -1;
 
-AnalogIn potentiometer(A0);
-AnalogIn lm35(A1);
+uartMode_t uartMode = UART_MODE_COMMANDS;
+volatile bool uartTaskPending = false;
+int uartTimingProbe = -1;
+bool availableCommandsActive = false;   // Ayuda saliendo por partes, comando 'h'
+bool flashLogDumpActive = false;        // Volcado del log en curso, comando 'l'
 
-//=====[Declaration and initialization of public global variables]=============
+// Indices de taskSupervisorCheckIn(); -1 hasta registrarse, se ignoran
+int sensorsSupervisorTask = -1;
+int alarmSupervisorTask = -1;
+int consoleSupervisorTask = -1;
+int telemetrySupervisorTask = -1;
 
-bool alarmState    = OFF;
-bool incorrectCode = false;
-bool overTempDetector = OFF;
+int buttonBeingCompared    = 0;
+uint32_t codeEntered  = 0;       // Bit 0 'A' ... bit 3 'D', ingresado por UART
 
-bool enterButtonState = buttons[0]; //ENTER
-bool alarmTestButtonState = buttons[1];//D3
-bool aButtonState = buttons[2];//D4
-bool bButtonState = buttons[3];//D5
-bool cButtonState = buttons[4];//D6
-bool dButtonState = buttons[5];//D7
+uint32_t streamChannelsEntered = 0;   // Mascara en hexadecimal del comando 'b'
+int streamDigitsReceived = 0;
 
-int numberOfIncorrectCodes = 0;
-int buttonBeingCompared    = 0;
-int codeSequence[NUMBER_OF_KEYS]   = { 1, 1, 0, 0 };
-int buttonsPressed[NUMBER_OF_KEYS] = { 0, 0, 0, 0 };
-int accumulatedTimeAlarm = 0;
+int overTempLevelEntered = 0;         // Grados Celsius del comando 'o'
+int overTempDigitsReceived = 0;
+
+// Cambios de la palabra de estado, del hilo de alarma al de telemetria
+spscQueue_t<uint32_t, STATUS_QUEUE_SIZE> statusQueue;
+uint32_t statusWordQueued = 0xFFFFFFFF;
+
+// Ultimo estado registrado en el log de flash, para guardar solo los cambios
+bool alarmActiveLogged = false;
+bool incorrectCodeLogged = false;
+bool keypadLockedLogged = false;
+
+// La escribe solo alarmActivationUpdate()
+seqlock_t<sensorSnapshot_t> sensorSnapshot;
+
+// Respuestas constantes de la consola, indexadas por el estado que informan
+const char* const alarmStateResponses[2] = {
+    "The alarm is not activated\r\n",
+    "The alarm is activated\r\n",
+};
+const char* const gasDetectorResponses[2] = {
+    "Gas is not being detected\r\n",
+    "Gas is being detected\r\n",
+};
+const char* const overTempDetectorResponses[2] = {
+    "Temperature is below the maximum level\r\n",
+    "Temperature is above the maximum level\r\n",
+};
+
+const char codeSequenceHelp[] =
+    "Please enter the code sequence.\r\n"
+    "First enter 'A', then 'B', then 'C', and finally 'D' button\r\n"
+    "In each case type 1 for pressed or 0 for not pressed\r\n"
+    "For example, for 'A' = pressed, 'B' = pressed, 'C' = not pressed, "
+    "'D' = not pressed, enter '1', then '1', then '0', and finally '0'\r\n\r\n";
+
+const char newCodeSequenceHelp[] =
+    "Please enter new code sequence\r\n"
+    "First enter 'A', then 'B', then 'C', and finally 'D' button\r\n"
+    "In each case type 1 for pressed or 0 for not pressed\r\n"
+    "For example, for 'A' = pressed, 'B' = pressed, 'C' = not pressed,"
+    "'D' = not pressed, enter '1', then '1', then '0', and finally '0'\r\n\r\n";
 
-bool gasDetectorState          = OFF;
-bool overTempDetectorState     = OFF;
+const char streamChannelsHelp[] =
+    "Enter the stream channel mask as two hex digits\r\n"
+    "Bit 0 LM35 raw, bit 1 potentiometer, bit 2 MQ-2, "
+    "bit 3 LM35 filtered; 00 stops the stream\r\n";
 
-float potentiometerReading = 0.0;
-float lm35ReadingsAverage  = 0.0;
-float lm35ReadingsSum      = 0.0;
-float lm35ReadingsArray[NUMBER_OF_AVG_SAMPLES];
-float lm35TempC            = 0.0;
+const char overTempLevelHelp[] =
+    "Enter the maximum temperature in Celsius as two digits\r\n";
 
 //=====[Declarations (prototypes) of public functions]=========================
 
-void inputsInit();
 void outputsInit();
+void overTempDetectionInit();
+void telemetryTaskInit();
+void consoleInit();
+void consoleHeartbeatUpdate();
 
+void buttonsEventsUpdate();
+void buttonsNotify();
+void sensorSamplesUpdate();
+void digitalEdgeNotify();
+void digitalEdgeUpdate();
 void alarmActivationUpdate();
-void alarmDeactivationUpdate();
+void sensorSnapshotPublish();
+void alarmDeactivationUpdate( bool enterButtonPressed );
+void alarmFsmNotify();
+void alarmFsmTaskRun();
+void statusReportUpdate();
+void telemetryTaskUpdate();
+void flashLogSampleUpdate();
+void flashLogEventsUpdate();
+void alarmEventLog( flashLogEvent_t event );
+void netTelemetryTaskUpdate();
+void flashLogDumpUpdate();
 
 void uartTask();
+void uartCodeDigitUpdate( char receivedChar );
+void uartNewCodeDigitUpdate( char receivedChar );
+void uartStreamChannelsDigitUpdate( char receivedChar );
+void uartOverTempLevelDigitUpdate( char receivedChar );
+void uartRxNotify();
+void uartTaskRun();
+void alarmStateWrite();
+void gasDetectorStateWrite();
+void overTempDetectorStateWrite();
+void codeEntryStart();
+void newCodeEntryStart();
+void potentiometerReadingWrite();
+void celsiusReadingWrite();
+void fahrenheitReadingWrite();
+void telemetryLevelNext();
+void powerReportWrite();
+void taskTimingClear();
+void alarmLatencyClear();
+void flashLogDump();
+void streamChannelsEntryStart();
+void overTempLevelEntryStart();
 void availableCommands();
-bool areEqual();
-float celsiusToFahrenheit( float tempInCelsiusDegrees );
-float analogReadingScaledWithTheLM35Formula( float analogReading );
+void availableCommandsUpdate();
+bool consoleGetCommand( int argc, const char* const* argv );
+bool consoleSetCommand( int argc, const char* const* argv );
+bool consoleHelpCommand( int argc, const char* const* argv );
+void alarmValueWrite( const sensorSnapshot_t* snapshot, char unit );
+void gasValueWrite( const sensorSnapshot_t* snapshot, char unit );
+void overTempValueWrite( const sensorSnapshot_t* snapshot, char unit );
+void temperatureValueWrite( const sensorSnapshot_t* snapshot, char unit );
+void potentiometerValueWrite( const sensorSnapshot_t* snapshot, char unit );
+void thresholdValueWrite( const sensorSnapshot_t* snapshot, char unit );
+void telemetryValueWrite( const sensorSnapshot_t* snapshot, char unit );
+void streamValueWrite( const sensorSnapshot_t* snapshot, char unit );
+void uptimeValueWrite( const sensorSnapshot_t* snapshot, char unit );
+const char* thresholdSettingWrite( const char* value );
+const char* telemetrySettingWrite( const char* value );
+const char* streamSettingWrite( const char* value );
+const char* overTempLevelWrite( int celsius );
+void taskTimingReportWrite();
+void taskSupervisorReportWrite();
+void taskSupervisorClear();
+void netTelemetryReportWrite();
+void alarmLatencyReportWrite();
+void sensorChannelsReportWrite();
+bool areEqual( uint32_t code );
+int celsiusToFahrenheit( int tempInCelsiusDegrees );
+int analogReadingScaledWithTheLM35Formula( uint16_t analogReading );
+int potentiometerCentesimal( uint16_t reading );
+
+//=====[Declaration and initialization of console command tables]==============
+
+// Van despues de los prototipos porque apuntan a los handlers. El orden es
+// el de la ayuda.
+const consoleKeyCommand_t consoleKeyCommands[] = {
+    { "1",   "get the alarm state",                      alarmStateWrite },
+    { "2",   "get the gas detector state",               gasDetectorStateWrite },
+    { "3",   "get the over temperature detector state",  overTempDetectorStateWrite },
+    { "4",   "enter the code sequence",                  codeEntryStart },
+    { "5",   "enter a new code",                         newCodeEntryStart },
+    { "pP",  "get potentiometer reading",                potentiometerReadingWrite },
+    { "fF",  "get lm35 reading in Fahrenheit",           fahrenheitReadingWrite },
+    { "cC",  "get lm35 reading in Celsius",              celsiusReadingWrite },
+    { "vV",  "change the status telemetry level",        telemetryLevelNext },
+    { "sS",  "get the power budget report",              powerReportWrite },
+    { "t",   "get the task timing report",               taskTimingReportWrite },
+    { "T",   "clear the task timing report",             taskTimingClear },
+    { "w",   "get the task deadline report",             taskSupervisorReportWrite },
+    { "W",   "clear the task deadline counters",         taskSupervisorClear },
+    { "nN",  "get the network telemetry status",         netTelemetryReportWrite },
+    { "a",   "get the alarm latency report",             alarmLatencyReportWrite },
+    { "A",   "clear the alarm latency report",           alarmLatencyClear },
+    { "lL",  "dump the flash log",                       flashLogDump },
+    { "bB",  "select the binary sensor stream channels", streamChannelsEntryStart },
+    { "zZ",  "list the sensor channels",                 sensorChannelsReportWrite },
+    { "oO",  "set the maximum temperature",              overTempLevelEntryStart },
+    { "hH?", "get this help",                            availableCommands },
+};
+
+const consoleLineCommand_t consoleLineCommands[] = {
+    { "get",  "<value> [<value>...]",
+      "read alarm, gas, overtemp, temp [c|f], pot, threshold, telemetry, stream, uptime",
+      consoleGetCommand },
+    { "set",  "<setting> <value>",
+      "threshold <celsius>, telemetry <0-2>, stream <hex mask>",
+      consoleSetCommand },
+    { "help", "", "get this help", consoleHelpCommand },
+};
+
+const consoleValue_t consoleValues[] = {
+    { "alarm",     "", alarmValueWrite },
+    { "gas",       "", gasValueWrite },
+    { "overtemp",  "", overTempValueWrite },
+    { "temp",      "cf", temperatureValueWrite },
+    { "pot",       "", potentiometerValueWrite },
+    { "threshold", "", thresholdValueWrite },
+    { "telemetry", "", telemetryValueWrite },
+    { "stream",    "", streamValueWrite },
+    { "uptime",    "", uptimeValueWrite },
+};
+
+const consoleSetting_t consoleSettings[] = {
+    { "threshold", thresholdSettingWrite },
+    { "telemetry", telemetrySettingWrite },
+    { "stream",    streamSettingWrite },
+};
 
 //=====[Main function, the program entry point after power on or reset]========
 
+// La compilacion de benchmark (benchmark/benchmark_app.json) reutiliza las
+// funciones de este archivo con su propio main().
+#ifndef BENCHMARK_BUILD
 int main()
 {
-
-    inputsInit();       //Inicializacion de pines de entrada
+    // Primero el camino de seguridad: sirena, sensores con el filtro ya
+    // cargado y una evaluacion inmediata, para que la alarma proteja a los
+    // pocos milisegundos del reset. La consola y la telemetria arrancan
+    // despues, en sus propios hilos.
+    taskTimingInit();   //Contador de ciclos para las sondas y las marcas de tiempo, comando 't'
+    taskSupervisorInit();   //Plazos perdidos de antes del reset, comando 'w'
+    alarmLatencyInit();     //Latencia de sensor a sirena, comando 'a'
     outputsInit();      //Inicializacion de pines de salida
-    while (true) {      //Loop principal
+    configStoreInit();  //Codigo, umbrales, parpadeo y ventana guardados en flash
+    sensorRegistryInit( digitalEdgeNotify );   //Canales de la placa, muestreados por timer
+    sensorRegistryWindowWrite( configStoreRead()->numberOfAvgSamples );
+    overTempDetectionInit();    //Umbral, histeresis y velocidad de subida configurados
 
-        enterButtonState = buttons[0]; //ENTER
-        alarmTestButtonState = buttons[1];//D3
-        aButtonState = buttons[2];//D4
-        bButtonState = buttons[3];//D5
-        cButtonState = buttons[4];//D6
-        dButtonState = buttons[5];//D7
-        alarmActivationUpdate();    //Actualizacion evento de activacion de alarma
-        alarmDeactivationUpdate();  //Actualizacion evento de desactivacion de alarma
-        uartTask();                 //Comunicacion por puerto serie
-        printf("Enter Button: %d, Alarm Test Button: %d, A Button: %d, B Button: %d, C Button: %d, D Button: %d, Alarm LED: %d\n",
-               enterButtonState, alarmTestButtonState, aButtonState, bButtonState, cButtonState, dButtonState, alarmState);
-        //printf("Valor potenciometro %f \n",lm35.read());
-        delay(TIME_INCREMENT_MS);   //Delay de 10ms
+    seqlockInit( &sensorSnapshot );     //Lecturas publicadas para la consola y el log
+    alarmFsmInit( alarmFsmNotify );     //Maquina de estados de la alarma, atendida ante cada evento
+    alarmActivationUpdate();    //Un detector ya activo enciende la sirena antes de seguir
+    alarmFsmUpdate();
+    buttonsInit( buttonsNotify );       //Botones con debounce, atendidos ante cada evento
+
+    buttonsTimingProbe = taskTimingProbeAdd( "buttons", TIME_INCREMENT_MS * 1000 );
+    uartTimingProbe = taskTimingProbeAdd( "uart", TIME_INCREMENT_MS * 1000 );
+    sensorsSupervisorTask = taskSupervisorTaskAdd( "sensors", SENSORS_DEADLINE_MS, true );
+    alarmSupervisorTask = taskSupervisorTaskAdd( "alarm", ALARM_DEADLINE_MS, true );
+    consoleSupervisorTask = taskSupervisorTaskAdd( "console", CONSOLE_DEADLINE_MS, true );
+    telemetrySupervisorTask = taskSupervisorTaskAdd( "telemetry", TELEMETRY_DEADLINE_MS, false );
+    spscQueueInit( &statusQueue );
+
+    netTelemetryInit();     //Eventos y resumenes por UDP si "net-telemetry" esta habilitado, comando 'n'
+    flashLogInit();     //Historial en flash, comando 'l'
+    alarmEventLog( FLASH_LOG_EVENT_BOOT );
+    if ( taskSupervisorWatchdogReset() ) {
+        alarmEventLog( FLASH_LOG_EVENT_WATCHDOG_RESET );
     }
+
+    schedulerInit();
+    schedulerAddPeriodicTask( SCHEDULER_CONTEXT_ALARM, "sensors", TIME_INCREMENT_MS,
+                              sensorSamplesUpdate );     //Procesamiento de las muestras adquiridas
+    schedulerAddPeriodicTask( SCHEDULER_CONTEXT_ALARM, "alarm", TIME_INCREMENT_MS,
+                              alarmActivationUpdate );   //Actualizacion evento de activacion de alarma
+    schedulerAddPeriodicTask( SCHEDULER_CONTEXT_ALARM, "status", TIME_INCREMENT_MS,
+                              statusReportUpdate );      //Palabra de estado hacia la telemetria
+    schedulerAddPeriodicTask( SCHEDULER_CONTEXT_TELEMETRY, "telemetry", TIME_INCREMENT_MS,
+                              telemetryTaskUpdate );     //Telemetria de estado, solo ante cambios
+    schedulerAddPeriodicTask( SCHEDULER_CONTEXT_ALARM, "logsample", FLASH_LOG_SAMPLE_PERIOD_MS,
+                              flashLogSampleUpdate );    //Muestra de temperatura y gas al log
+    schedulerAddPeriodicTask( SCHEDULER_CONTEXT_ALARM, "logevents", TIME_INCREMENT_MS,
+                              flashLogEventsUpdate );    //Cambios de estado de la alarma al log
+    schedulerAddPeriodicTask( SCHEDULER_CONTEXT_TELEMETRY, "logwrite", TIME_INCREMENT_MS,
+                              flashLogUpdate );          //Grabacion de paginas del log en flash
+    schedulerAddPeriodicTask( SCHEDULER_CONTEXT_TELEMETRY, "stream", TIME_INCREMENT_MS,
+                              sensorStreamUpdate );      //Tramas binarias de muestras
+    schedulerAddPeriodicTask( SCHEDULER_CONTEXT_TELEMETRY, "config", TIME_INCREMENT_MS,
+                              configStoreUpdate );       //Grabacion diferida de la configuracion
+    schedulerAddPeriodicTask( SCHEDULER_CONTEXT_CONSOLE, "heartbeat", CONSOLE_HEARTBEAT_PERIOD_MS,
+                              consoleHeartbeatUpdate );  //Prueba de vida de la consola
+#if NET_TELEMETRY_ENABLED
+    schedulerAddPeriodicTask( SCHEDULER_CONTEXT_TELEMETRY, "network", TIME_INCREMENT_MS,
+                              netTelemetryTaskUpdate );  //Conexion y envios UDP, sin bloquear
+#endif
+
+    // Corren apenas arranca cada hilo, antes de su primera tarea periodica
+    schedulerPost( SCHEDULER_CONTEXT_TELEMETRY, telemetryTaskInit );
+    schedulerPost( SCHEDULER_CONTEXT_CONSOLE, consoleInit );
+
+    taskSupervisorStart();  //Plazos de las tareas y watchdog, desde aca en adelante
+    schedulerRun();     //Hilos de alarma, consola y telemetria, no retorna
 }
+#endif // BENCHMARK_BUILD
 
 //=====[Implementations of public functions]===================================
 
-void inputsInit()
+void outputsInit()
 {
-    buttons[1].mode(PullDown);
-    buttons[2].mode(PullDown);
-    buttons[3].mode(PullDown);
-    buttons[4].mode(PullDown);
-    buttons[5].mode(PullDown);
-    sirenPin.mode(OpenDrain);
-    sirenPin.input();
+    alarmOutputInit();  //Sirena y leds
 }
 
-void outputsInit()
+// El detector se activa al superar el umbral o al subir mas rapido que la
+// velocidad configurada, y no se apaga hasta bajar la histeresis completa.
+// Corre en el hilo de alarma, tambien cuando el comando 'o' cambia el umbral.
+void overTempDetectionInit()
 {
-    leds[0] = OFF;
-    leds[1] = OFF;
-    leds[2] = OFF;
+    const configStoreSettings_t* settings = configStoreRead();
+    sensorDetection_t detection;
+
+    detection.onLevel  = LM35_READING( settings->overTempLevelCentiC );
+    detection.offLevel = LM35_READING( settings->overTempLevelCentiC -
+                                       settings->overTempHysteresisCentiC );
+    detection.riseLimit = ( settings->overTempRiseRateCentiCPerS * ADC_FULL_SCALE +
+                            LM35_CENTI_DEGREES_FULL_SCALE / 2 ) / LM35_CENTI_DEGREES_FULL_SCALE;
+    sensorRegistryDetectionWrite( SENSOR_KIND_TEMPERATURE, &detection );
 }
 
-void alarmActivationUpdate()
+void telemetryTaskInit()
+{
+    telemetryInit( TELEMETRY_DEFAULT_PERIOD_MS );
+    sensorStreamInit();     //Envio binario de muestras, comando 'b'
+}
+
+void consoleInit()
+{
+    consoleCommandInit( consoleKeyCommands,
+                        sizeof( consoleKeyCommands ) / sizeof( consoleKeyCommands[0] ),
+                        consoleLineCommands,
+                        sizeof( consoleLineCommands ) / sizeof( consoleLineCommands[0] ) );
+    pcSerialComInit( uartRxNotify );    //Comunicacion por puerto serie, atendida al recibir datos
+}
+
+// La consola solo corre ante caracteres recibidos; esta tarea demuestra
+// que su hilo no quedo trabado aunque nadie escriba
+void consoleHeartbeatUpdate()
+{
+    taskSupervisorCheckIn( consoleSupervisorTask );
+}
+
+// Se ejecuta solo cuando el modulo de botones informa un cambio ya filtrado
+// del rebote, por lo que una pulsacion de Enter es un unico evento.
+void buttonsEventsUpdate()
 {
-    static int lm35SampleIndex = 0;
-    int i = 0;
+    buttonsEvent_t event;
+    uint32_t startCycles = taskTimingStart();
 
-    lm35ReadingsArray[lm35SampleIndex] = lm35.read();
-    lm35SampleIndex++;
-    if ( lm35SampleIndex >= NUMBER_OF_AVG_SAMPLES) {
-        lm35SampleIndex = 0;
+    buttonsTaskPending = false;
+
+    while ( buttonsEventRead( &event ) ) {
+        buttonsState = buttonsStateRead();
+
+        alarmDeactivationUpdate( event.button == BUTTON_ENTER && event.pressed );
     }
-    
-       lm35ReadingsSum = 0.0;
-    for (i = 0; i < NUMBER_OF_AVG_SAMPLES; i++) {
-        lm35ReadingsSum = lm35ReadingsSum + lm35ReadingsArray[i];
+
+    taskTimingStop( buttonsTimingProbe, startCycles );
+}
+
+// Se llama desde interrupcion
+void buttonsNotify()
+{
+    if ( !buttonsTaskPending ) {
+        buttonsTaskPending = true;
+        if ( !schedulerPost( SCHEDULER_CONTEXT_ALARM, buttonsEventsUpdate ) ) {
+            buttonsTaskPending = false;   // Cola llena: el proximo flanco reintenta
+        }
     }
-    lm35ReadingsAverage = lm35ReadingsSum / NUMBER_OF_AVG_SAMPLES;
-       lm35TempC = analogReadingScaledWithTheLM35Formula ( lm35ReadingsAverage );    
-    
-    if ( lm35TempC > OVER_TEMP_LEVEL ) {
-        overTempDetector = ON;
-    } else {
-        overTempDetector = OFF;
-    }
-
-    if( !mq2) {
-        gasDetectorState = ON;
-        alarmState = ON;
-    }
-    if( overTempDetector ) {
-        overTempDetectorState = ON;
-        alarmState = ON;
-    }
-    if( alarmTestButtonState ) {             
-        overTempDetectorState = ON;
-        gasDetectorState = ON;
-        alarmState = ON;
-    }    
-    if( alarmState ) { 
-        accumulatedTimeAlarm = accumulatedTimeAlarm + TIME_INCREMENT_MS;
-        sirenPin.output();                                     
-        sirenPin = LOW;                                        
-    
-        if( gasDetectorState && overTempDetectorState ) {
-            if( accumulatedTimeAlarm >= BLINKING_TIME_GAS_AND_OVER_TEMP_ALARM ) {
-                accumulatedTimeAlarm = 0;
-                leds[0] = !leds[0];
-            }
-        } else if( gasDetectorState ) {
-            if( accumulatedTimeAlarm >= BLINKING_TIME_GAS_ALARM ) {
-                accumulatedTimeAlarm = 0;
-                leds[0] = !leds[0];
-            }
-        } else if ( overTempDetectorState ) {
-            if( accumulatedTimeAlarm >= BLINKING_TIME_OVER_TEMP_ALARM  ) {
-                accumulatedTimeAlarm = 0;
-                leds[0] = !leds[0];
-            }
+}
+
+void sensorSamplesUpdate()
+{
+    // Fuera de la pila: el hilo de alarma es el de mayor prioridad y tiene poca
+    static adcSample_t samples[ADC_BATCH_SIZE];
+    int numberOfSamples;
+    int i;
+
+    do {
+        numberOfSamples = adcSamplerRead( samples, ADC_BATCH_SIZE );
+        for ( i = 0; i < numberOfSamples; i++ ) {
+            sensorRegistrySampleWrite( &samples[i] );
+            sensorStreamSampleWrite(
+                sensorRegistryRawRead( SENSOR_CHANNEL_ZONE1_TEMPERATURE ),
+                sensorRegistryRawRead( SENSOR_CHANNEL_POTENTIOMETER ),
+                sensorRegistryRawRead( SENSOR_CHANNEL_ZONE1_GAS ),
+                sensorRegistryAverageRead( SENSOR_CHANNEL_ZONE1_TEMPERATURE ) );
+        }
+    } while ( numberOfSamples == ADC_BATCH_SIZE );
+
+    sensorRegistryUpdate();
+    taskSupervisorCheckIn( sensorsSupervisorTask );
+}
+
+// Se llama desde la interrupcion de las entradas digitales: un flanco de un
+// MQ-2 se atiende en el momento aunque el sistema este dormido entre muestras.
+void digitalEdgeNotify()
+{
+    if ( !digitalEdgeTaskPending ) {
+        digitalEdgeTaskPending = true;
+        if ( !schedulerPost( SCHEDULER_CONTEXT_ALARM, digitalEdgeUpdate ) ) {
+            digitalEdgeTaskPending = false;
         }
-    } else{
-        leds[0] = OFF;
-        gasDetectorState = OFF;
-        overTempDetectorState = OFF;
-        sirenPin.input();                                  
     }
 }
 
-void alarmDeactivationUpdate()
+void digitalEdgeUpdate()
+{
+    digitalEdgeTaskPending = false;
+    sensorRegistryDigitalRefresh();
+    alarmActivationUpdate();
+}
+
+void alarmActivationUpdate()
 {
-    if ( numberOfIncorrectCodes < 5 ) {
-        if ( aButtonState && bButtonState && cButtonState && dButtonState && !enterButtonState ) {
-            leds[1] = OFF;
+    uint32_t detectors;
+    uint32_t activeChannels = sensorRegistryActiveChannels();
+    bool overTempDetectorWasOn = overTempDetector;
+    bool gasDetectorWasOn = gasDetector;
+
+    taskSupervisorCheckIn( alarmSupervisorTask );
+
+    overTempDetector = ( activeChannels &
+                         sensorRegistryKindChannels( SENSOR_KIND_TEMPERATURE ) ) != 0;
+    gasDetector = ( activeChannels & sensorRegistryKindChannels( SENSOR_KIND_GAS ) ) != 0;
+    sensorSnapshotPublish();
+
+    // La latencia se mide desde el flanco de un detector; si la condicion
+    // persiste al ingresar el codigo, la reactivacion no tiene flanco propio.
+    if( gasDetector && !gasDetectorWasOn ) {
+        alarmLatencySensorMark( ALARM_LATENCY_SOURCE_GAS,
+                                sensorRegistryActivationCyclesRead( SENSOR_KIND_GAS ) );
+    }
+    if( overTempDetector && !overTempDetectorWasOn ) {
+        alarmLatencySensorMark( ALARM_LATENCY_SOURCE_OVER_TEMP,
+                                sensorRegistryActivationCyclesRead( SENSOR_KIND_TEMPERATURE ) );
+    }
+
+    // Solo se genera un evento cuando la maquina de estados todavia no
+    // refleja la condicion; asi, si la condicion persiste luego de ingresar
+    // el codigo, la alarma vuelve a activarse como antes.
+    detectors = alarmFsmDetectorsRead();
+    if( gasDetector && !( detectors & ALARM_DETECTOR_GAS ) ) {
+        alarmFsmEventPost( ALARM_EVENT_GAS );
+    }
+    if( overTempDetector && !( detectors & ALARM_DETECTOR_OVER_TEMP ) ) {
+        alarmFsmEventPost( ALARM_EVENT_OVER_TEMP );
+    }
+    if( ( buttonsState & BUTTON_MASK( BUTTON_TEST ) ) &&
+        detectors != ( ALARM_DETECTOR_GAS | ALARM_DETECTOR_OVER_TEMP ) ) {
+        alarmFsmEventPost( ALARM_EVENT_TEST );
+    }
+}
+
+// Una sola publicacion por lote con todas las lecturas: los lectores nunca
+// ven la temperatura de un lote junto a los detectores de otro
+void sensorSnapshotPublish()
+{
+    sensorSnapshot_t snapshot;
+    int i;
+
+    snapshot.cycles = taskTimingStart();
+    for ( i = 0; i < SENSOR_NUMBER_OF_CHANNELS; i++ ) {
+        snapshot.values[i] = sensorRegistryRead( (sensorChannel_t) i );
+        snapshot.rises[i] = sensorRegistryRiseRead( (sensorChannel_t) i );
+    }
+    snapshot.activeChannels = sensorRegistryActiveChannels();
+    snapshot.temperatureCentiC = analogReadingScaledWithTheLM35Formula(
+                                     snapshot.values[SENSOR_CHANNEL_ZONE1_TEMPERATURE] );
+    snapshot.gasDetector = gasDetector;
+    snapshot.overTempDetector = overTempDetector;
+
+    seqlockWrite( &sensorSnapshot, snapshot );
+}
+
+void alarmDeactivationUpdate( bool enterButtonPressed )
+{
+    if ( alarmFsmKeypadLocked() ) {
+        return;
+    }
+
+    if ( ( buttonsState & ( BUTTONS_CODE_MASK | BUTTON_MASK( BUTTON_ENTER ) ) ) ==
+         BUTTONS_CODE_MASK ) {
+        alarmFsmEventPost( ALARM_EVENT_INCORRECT_CODE_CLEAR );
+    }
+    if ( enterButtonPressed && !alarmFsmIncorrectCodeRead() && alarmFsmIsActive() ) {
+        if ( areEqual( buttonsState >> BUTTON_A ) ) {
+            alarmFsmEventPost( ALARM_EVENT_CODE_OK );
+        } else {
+            alarmFsmEventPost( ALARM_EVENT_CODE_FAIL );
         }
-        if ( enterButtonState && !leds[1] && alarmState ) {
-            buttonsPressed[0] = aButtonState;
-            buttonsPressed[1] = bButtonState;
-            buttonsPressed[2] = cButtonState;
-            buttonsPressed[3] = dButtonState;
-            if ( areEqual() ) {
-                alarmState = OFF;
-                numberOfIncorrectCodes = 0;
-            } else {
-                leds[1] = ON;
-                numberOfIncorrectCodes++;
-            }
+    }
+}
+
+// Puede llamarse desde cualquier contexto
+void alarmFsmNotify()
+{
+    if ( !alarmFsmTaskPending ) {
+        alarmFsmTaskPending = true;
+        if ( !schedulerPost( SCHEDULER_CONTEXT_ALARM, alarmFsmTaskRun ) ) {
+            alarmFsmTaskPending = false;   // Lo reintenta el proximo aviso
         }
-    } else {
-        leds[2] = ON;
     }
 }
 
+void alarmFsmTaskRun()
+{
+    alarmFsmTaskPending = false;
+    alarmFsmUpdate();
+}
+
+// Los comandos '4' y '5' no esperan los cuatro digitos: la tarea guarda en
+// uartMode en que paso de la secuencia esta y sigue con los caracteres que
+// lleguen en las siguientes activaciones.
 void uartTask()
 {
     char receivedChar = '\0';
-    char str[100];
-    int stringLength;
-    if( uartUsb.readable() ) {
-        uartUsb.read( &receivedChar, 1 );
-        switch (receivedChar) {
-        case '1':
-            if ( alarmState ) {
-                uartUsb.write( "The alarm is activated\r\n", 24);
-            } else {
-                uartUsb.write( "The alarm is not activated\r\n", 28);
-            }
+
+    while( pcSerialComCharRead( &receivedChar ) ) {
+        switch ( uartMode ) {
+        case UART_MODE_GET_CODE:
+            uartCodeDigitUpdate( receivedChar );
             break;
 
-        case '2':
-            if ( !mq2 ) {
-                uartUsb.write( "Gas is being detected\r\n", 22);
-            } else {
-                uartUsb.write( "Gas is not being detected\r\n", 27);
-            }
+        case UART_MODE_SAVE_NEW_CODE:
+            uartNewCodeDigitUpdate( receivedChar );
             break;
 
-        case '3':
-            if ( overTempDetector ) {
-                uartUsb.write( "Temperature is above the maximum level\r\n", 40);
-            } else {
-                uartUsb.write( "Temperature is below the maximum level\r\n", 40);
-            }
+        case UART_MODE_STREAM_CHANNELS:
+            uartStreamChannelsDigitUpdate( receivedChar );
             break;
-            
-        case '4':
-            uartUsb.write( "Please enter the code sequence.\r\n", 33 );
-            uartUsb.write( "First enter 'A', then 'B', then 'C', and ", 41 ); 
-            uartUsb.write( "finally 'D' button\r\n", 20 );
-            uartUsb.write( "In each case type 1 for pressed or 0 for ", 41 );
-            uartUsb.write( "not pressed\r\n", 13 );
-            uartUsb.write( "For example, for 'A' = pressed, ", 32 );
-            uartUsb.write( "'B' = pressed, 'C' = not pressed, ", 34);
-            uartUsb.write( "'D' = not pressed, enter '1', then '1', ", 40 );
-            uartUsb.write( "then '0', and finally '0'\r\n\r\n", 29 );
-
-            incorrectCode = false;
-
-            for ( buttonBeingCompared = 0;
-                  buttonBeingCompared < NUMBER_OF_KEYS;
-                  buttonBeingCompared++) {
-
-                uartUsb.read( &receivedChar, 1 );
-                uartUsb.write( "*", 1 );
-
-                if ( receivedChar == '1' ) {
-                    if ( codeSequence[buttonBeingCompared] != 1 ) {
-                        incorrectCode = true;
-                    }
-                } else if ( receivedChar == '0' ) {
-                    if ( codeSequence[buttonBeingCompared] != 0 ) {
-                        incorrectCode = true;
-                    }
-                } else {
-                    incorrectCode = true;
-                }
-            }
 
-            if ( incorrectCode == false ) {
-                uartUsb.write( "\r\nThe code is correct\r\n\r\n", 25 );
-                alarmState = OFF;
-                leds[1] = OFF;
-                numberOfIncorrectCodes = 0;
-            } else {
-                uartUsb.write( "\r\nThe code is incorrect\r\n\r\n", 27 );
-                leds[1] = ON;
-                numberOfIncorrectCodes++;
-            }                
+        case UART_MODE_OVER_TEMP_LEVEL:
+            uartOverTempLevelDigitUpdate( receivedChar );
+            break;
+
+        case UART_MODE_COMMANDS:
+        default:
+            consoleCommandCharWrite( receivedChar );
             break;
+        }
+    }
+}
+
+void alarmStateWrite()
+{
+    pcSerialComStringWrite( alarmStateResponses[alarmFsmIsActive()] );
+}
+
+void gasDetectorStateWrite()
+{
+    sensorSnapshot_t snapshot;
+
+    seqlockRead( &sensorSnapshot, &snapshot );
+    pcSerialComStringWrite( gasDetectorResponses[snapshot.gasDetector] );
+}
+
+void overTempDetectorStateWrite()
+{
+    sensorSnapshot_t snapshot;
+
+    seqlockRead( &sensorSnapshot, &snapshot );
+    pcSerialComStringWrite( overTempDetectorResponses[snapshot.overTempDetector] );
+}
+
+// Los comandos '4' y '5' siguen en uartTask() con los digitos del codigo
+void codeEntryStart()
+{
+    pcSerialComStringWrite( codeSequenceHelp );
+
+    incorrectCode = false;
+    codeEntered = 0;
+    buttonBeingCompared = 0;
+    uartMode = UART_MODE_GET_CODE;
+}
+
+void newCodeEntryStart()
+{
+    pcSerialComStringWrite( newCodeSequenceHelp );
+
+    incorrectCode = false;
+    codeEntered = 0;
+    buttonBeingCompared = 0;
+    uartMode = UART_MODE_SAVE_NEW_CODE;
+}
+
+void potentiometerReadingWrite()
+{
+    sensorSnapshot_t snapshot;
+
+    seqlockRead( &sensorSnapshot, &snapshot );
+    pcSerialComMessageBegin();
+    pcSerialComMessageString( "Potentiometer: " );
+    pcSerialComMessageCentesimal(
+        potentiometerCentesimal( snapshot.values[SENSOR_CHANNEL_POTENTIOMETER] ) );
+    pcSerialComMessageString( "\r\n" );
+    pcSerialComMessageEnd();
+}
+
+void celsiusReadingWrite()
+{
+    sensorSnapshot_t snapshot;
+
+    seqlockRead( &sensorSnapshot, &snapshot );
+    pcSerialComMessageBegin();
+    pcSerialComMessageString( "Temperature: " );
+    pcSerialComMessageCentesimal( snapshot.temperatureCentiC );
+    pcSerialComMessageString( " \xB0 C\r\n" );
+    pcSerialComMessageEnd();
+}
+
+void fahrenheitReadingWrite()
+{
+    sensorSnapshot_t snapshot;
+
+    seqlockRead( &sensorSnapshot, &snapshot );
+    pcSerialComMessageBegin();
+    pcSerialComMessageString( "Temperature: " );
+    pcSerialComMessageCentesimal( celsiusToFahrenheit( snapshot.temperatureCentiC ) );
+    pcSerialComMessageString( " \xB0 F\r\n" );
+    pcSerialComMessageEnd();
+}
+
+void telemetryLevelNext()
+{
+    telemetryLevelWrite( (telemetryLevel_t)
+        ( ( telemetryLevelRead() + 1 ) % TELEMETRY_NUMBER_OF_LEVELS ) );
+    pcSerialComMessageBegin();
+    pcSerialComMessageString( "Telemetry level: " );
+    pcSerialComMessageUnsigned( telemetryLevelRead() );
+    pcSerialComMessageString( "\r\n" );
+    pcSerialComMessageEnd();
+}
+
+void powerReportWrite()
+{
+    powerMonitorReport_t powerReport;
+
+    powerMonitorRead( &powerReport );
+    pcSerialComMessageBegin();
+    pcSerialComMessageString( "Uptime: " );
+    pcSerialComMessageUnsigned( powerReport.uptimeS );
+    pcSerialComMessageString( " s, awake: " );
+    pcSerialComMessageCentesimal( powerReport.awakeCentiPercent );
+    pcSerialComMessageString( " %, sleep: " );
+    pcSerialComMessageCentesimal( powerReport.sleepCentiPercent );
+    pcSerialComMessageString( " %, deep sleep: " );
+    pcSerialComMessageCentesimal( powerReport.deepSleepCentiPercent );
+    pcSerialComMessageString( powerReport.deepSleepAllowed ?
+                              " %, deep sleep allowed\r\n" :
+                              " %, deep sleep locked\r\n" );
+    pcSerialComMessageEnd();
+}
 
-        case '5':
-            uartUsb.write( "Please enter new code sequence\r\n", 32 );
-            uartUsb.write( "First enter 'A', then 'B', then 'C', and ", 41 );
-            uartUsb.write( "finally 'D' button\r\n", 20 );
-            uartUsb.write( "In each case type 1 for pressed or 0 for not ", 45 );
-            uartUsb.write( "pressed\r\n", 9 );
-            uartUsb.write( "For example, for 'A' = pressed, 'B' = pressed,", 46 );
-            uartUsb.write( " 'C' = not pressed,", 19 );
-            uartUsb.write( "'D' = not pressed, enter '1', then '1', ", 40 );
-            uartUsb.write( "then '0', and finally '0'\r\n\r\n", 29 );
-
-            for ( buttonBeingCompared = 0; 
-                  buttonBeingCompared < NUMBER_OF_KEYS; 
-                  buttonBeingCompared++) {
-
-                uartUsb.read( &receivedChar, 1 );
-                uartUsb.write( "*", 1 );
-
-                if ( receivedChar == '1' ) {
-                    codeSequence[buttonBeingCompared] = 1;
-                } else if ( receivedChar == '0' ) {
-                    codeSequence[buttonBeingCompared] = 0;
-                }
+void taskTimingClear()
+{
+    taskTimingReset();
+    pcSerialComStringWrite( "Task timing statistics cleared\r\n" );
+}
+
+void alarmLatencyClear()
+{
+    alarmLatencyReset();
+    pcSerialComStringWrite( "Alarm latency statistics cleared\r\n" );
+}
+
+// Un volcado completo tarda decenas de segundos; volver a pedirlo mientras
+// sale se ignora, para no mezclar dos volcados ni encolar otra cadena
+void flashLogDump()
+{
+    if ( flashLogDumpActive ) {
+        return;
+    }
+    flashLogDumpStart();
+    flashLogDumpActive = schedulerPost( SCHEDULER_CONTEXT_CONSOLE, flashLogDumpUpdate );
+}
+
+void streamChannelsEntryStart()
+{
+    pcSerialComStringWrite( streamChannelsHelp );
+
+    streamChannelsEntered = 0;
+    streamDigitsReceived = 0;
+    uartMode = UART_MODE_STREAM_CHANNELS;
+}
+
+void overTempLevelEntryStart()
+{
+    pcSerialComStringWrite( overTempLevelHelp );
+
+    overTempLevelEntered = 0;
+    overTempDigitsReceived = 0;
+    uartMode = UART_MODE_OVER_TEMP_LEVEL;
+}
+
+// Cada valor pedido agrega "nombre=valor" a una sola linea de respuesta.
+// Una unidad va como token aparte despues del nombre: "get temp f pot".
+// Todos los valores salen de la misma copia de sensorSnapshot.
+bool consoleGetCommand( int argc, const char* const* argv )
+{
+    sensorSnapshot_t snapshot;
+    const consoleValue_t* value;
+    char unit;
+    int numberOfValues = sizeof( consoleValues ) / sizeof( consoleValues[0] );
+    int arg;
+    int i;
+
+    if ( argc < 2 ) {
+        consoleCommandErrorWrite( argv[0], "missing value" );
+        return false;
+    }
+    seqlockRead( &sensorSnapshot, &snapshot );
+
+    for ( arg = 1; arg < argc; arg++ ) {
+        value = NULL;
+        for ( i = 0; i < numberOfValues; i++ ) {
+            if ( strcmp( argv[arg], consoleValues[i].name ) == 0 ) {
+                value = &consoleValues[i];
+                break;
             }
+        }
+        if ( value == NULL ) {
+            pcSerialComMessageString( arg > 1 ? "\r\n" : "" );
+            consoleCommandErrorWrite( argv[arg], "unknown value" );
+            return false;
+        }
 
-            uartUsb.write( "\r\nNew code generated\r\n\r\n", 24 );
-            break;
- 
-        case 'p':
-        case 'P':
-            potentiometerReading = potentiometer.read();
-            sprintf ( str, "Potentiometer: %.2f\r\n", potentiometerReading );
-            stringLength = strlen(str);
-            uartUsb.write( str, stringLength );
-            break;
+        pcSerialComMessageString( arg > 1 ? " " : "" );
+        unit = value->units[0];
+        if ( unit != '\0' && arg + 1 < argc && argv[arg + 1][1] == '\0' &&
+             strchr( value->units, argv[arg + 1][0] ) != NULL ) {
+            unit = argv[++arg][0];
+        }
+        value->write( &snapshot, unit );
+    }
+    pcSerialComMessageString( "\r\n" );
 
-        case 'c':
-        case 'C':
-            sprintf ( str, "Temperature: %.2f \xB0 C\r\n", lm35TempC );
-            stringLength = strlen(str);
-            uartUsb.write( str, stringLength );
-            break;
+    return true;
+}
 
-        case 'f':
-        case 'F':
-            sprintf ( str, "Temperature: %.2f \xB0 F\r\n", 
-            celsiusToFahrenheit( lm35TempC ) );
-            stringLength = strlen(str);
-            uartUsb.write( str, stringLength );
-            break;
+bool consoleSetCommand( int argc, const char* const* argv )
+{
+    const char* error = "unknown setting";
+    int numberOfSettings = sizeof( consoleSettings ) / sizeof( consoleSettings[0] );
+    int i;
 
-        default:
-            availableCommands();
+    if ( argc != 3 ) {
+        consoleCommandErrorWrite( argv[0], "expected a setting and a value" );
+        return false;
+    }
+
+    for ( i = 0; i < numberOfSettings; i++ ) {
+        if ( strcmp( argv[1], consoleSettings[i].name ) == 0 ) {
+            error = consoleSettings[i].write( argv[2] );
             break;
+        }
+    }
+    if ( error != NULL ) {
+        consoleCommandErrorWrite( argv[1], error );
+        return false;
+    }
 
+    pcSerialComMessageString( argv[1] );
+    pcSerialComMessageString( "=" );
+    pcSerialComMessageString( argv[2] );
+    pcSerialComMessageString( "\r\n" );
+    return true;
+}
+
+// La ayuda sale despues de la respuesta, a medida que haya lugar en TX
+bool consoleHelpCommand( int argc, const char* const* argv )
+{
+    availableCommands();
+    return true;
+}
+
+void alarmValueWrite( const sensorSnapshot_t* snapshot, char unit )
+{
+    pcSerialComMessageString( "alarm=" );
+    pcSerialComMessageUnsigned( alarmFsmIsActive() );
+}
+
+void gasValueWrite( const sensorSnapshot_t* snapshot, char unit )
+{
+    pcSerialComMessageString( "gas=" );
+    pcSerialComMessageUnsigned( snapshot->gasDetector );
+}
+
+void overTempValueWrite( const sensorSnapshot_t* snapshot, char unit )
+{
+    pcSerialComMessageString( "overtemp=" );
+    pcSerialComMessageUnsigned( snapshot->overTempDetector );
+}
+
+void temperatureValueWrite( const sensorSnapshot_t* snapshot, char unit )
+{
+    if ( unit == 'f' ) {
+        pcSerialComMessageString( "temp_f=" );
+        pcSerialComMessageCentesimal( celsiusToFahrenheit( snapshot->temperatureCentiC ) );
+    } else {
+        pcSerialComMessageString( "temp_c=" );
+        pcSerialComMessageCentesimal( snapshot->temperatureCentiC );
+    }
+}
+
+void potentiometerValueWrite( const sensorSnapshot_t* snapshot, char unit )
+{
+    pcSerialComMessageString( "pot=" );
+    pcSerialComMessageCentesimal(
+        potentiometerCentesimal( snapshot->values[SENSOR_CHANNEL_POTENTIOMETER] ) );
+}
+
+void thresholdValueWrite( const sensorSnapshot_t* snapshot, char unit )
+{
+    pcSerialComMessageString( "threshold=" );
+    pcSerialComMessageCentesimal( configStoreRead()->overTempLevelCentiC );
+}
+
+void telemetryValueWrite( const sensorSnapshot_t* snapshot, char unit )
+{
+    pcSerialComMessageString( "telemetry=" );
+    pcSerialComMessageUnsigned( telemetryLevelRead() );
+}
+
+void streamValueWrite( const sensorSnapshot_t* snapshot, char unit )
+{
+    pcSerialComMessageString( "stream=" );
+    pcSerialComMessageHex( sensorStreamSubscription(), 2 );
+}
+
+void uptimeValueWrite( const sensorSnapshot_t* snapshot, char unit )
+{
+    powerMonitorReport_t powerReport;
+
+    powerMonitorRead( &powerReport );
+    pcSerialComMessageString( "uptime=" );
+    pcSerialComMessageUnsigned( powerReport.uptimeS );
+}
+
+const char* thresholdSettingWrite( const char* value )
+{
+    uint32_t celsius;
+
+    if ( !consoleCommandArgUnsigned( value, 10, &celsius ) || celsius > 150 ) {
+        return "invalid temperature";
+    }
+    return overTempLevelWrite( celsius );
+}
+
+const char* telemetrySettingWrite( const char* value )
+{
+    uint32_t level;
+
+    if ( !consoleCommandArgUnsigned( value, 10, &level ) ||
+         level >= TELEMETRY_NUMBER_OF_LEVELS ) {
+        return "invalid level";
+    }
+    telemetryLevelWrite( (telemetryLevel_t) level );
+    return NULL;
+}
+
+const char* streamSettingWrite( const char* value )
+{
+    uint32_t channelMask;
+
+    if ( !consoleCommandArgUnsigned( value, 16, &channelMask ) || channelMask > 0xFF ) {
+        return "invalid channel mask";
+    }
+    sensorStreamSubscribe( channelMask );
+    return NULL;
+}
+
+void uartCodeDigitUpdate( char receivedChar )
+{
+    pcSerialComCharWrite( '*' );
+
+    if ( receivedChar == '1' ) {
+        codeEntered |= 1UL << buttonBeingCompared;
+    } else if ( receivedChar != '0' ) {
+        incorrectCode = true;
+    }
+
+    buttonBeingCompared++;
+    if ( buttonBeingCompared < alarmConfig::numberOfKeys ) {
+        return;
+    }
+
+    if ( incorrectCode == false && areEqual( codeEntered ) ) {
+        pcSerialComStringWrite( "\r\nThe code is correct\r\n\r\n" );
+        alarmFsmEventPost( ALARM_EVENT_CODE_OK );
+    } else {
+        pcSerialComStringWrite( "\r\nThe code is incorrect\r\n\r\n" );
+        alarmFsmEventPost( ALARM_EVENT_CODE_FAIL );
+    }
+    uartMode = UART_MODE_COMMANDS;
+}
+
+// El codigo nuevo se arma aparte y recien se guarda al completar los cuatro
+// digitos. Solo se guarda su hash, asi que un caracter invalido no puede
+// conservar la tecla anterior: descarta el codigo entero.
+void uartNewCodeDigitUpdate( char receivedChar )
+{
+    pcSerialComCharWrite( '*' );
+
+    if ( receivedChar == '1' ) {
+        codeEntered |= 1UL << buttonBeingCompared;
+    } else if ( receivedChar != '0' ) {
+        incorrectCode = true;
+    }
+
+    buttonBeingCompared++;
+    if ( buttonBeingCompared < alarmConfig::numberOfKeys ) {
+        return;
+    }
+
+    if ( incorrectCode ) {
+        pcSerialComStringWrite( "\r\nInvalid code, the code was not changed\r\n\r\n" );
+    } else {
+        configStoreCodeWrite( codeEntered & CODE_SEQUENCE_MASK );
+        pcSerialComStringWrite( "\r\nNew code generated\r\n\r\n" );
+    }
+    incorrectCode = false;
+    uartMode = UART_MODE_COMMANDS;
+}
+
+// Un caracter que no es hexadecimal cancela el comando sin cambiar la
+// suscripcion.
+void uartStreamChannelsDigitUpdate( char receivedChar )
+{
+    int digit;
+
+    if ( receivedChar >= '0' && receivedChar <= '9' ) {
+        digit = receivedChar - '0';
+    } else if ( receivedChar >= 'a' && receivedChar <= 'f' ) {
+        digit = receivedChar - 'a' + 10;
+    } else if ( receivedChar >= 'A' && receivedChar <= 'F' ) {
+        digit = receivedChar - 'A' + 10;
+    } else {
+        pcSerialComStringWrite( "\r\nInvalid channel mask\r\n\r\n" );
+        uartMode = UART_MODE_COMMANDS;
+        return;
+    }
+
+    streamChannelsEntered = ( streamChannelsEntered << 4 ) | digit;
+    streamDigitsReceived++;
+    if ( streamDigitsReceived < 2 ) {
+        return;
+    }
+
+    sensorStreamSubscribe( streamChannelsEntered );
+    pcSerialComMessageBegin();
+    pcSerialComMessageString( "\r\nStreaming channels: 0x" );
+    pcSerialComMessageHex( sensorStreamSubscription(), 2 );
+    pcSerialComMessageString( "\r\n\r\n" );
+    pcSerialComMessageEnd();
+    uartMode = UART_MODE_COMMANDS;
+}
+
+void uartOverTempLevelDigitUpdate( char receivedChar )
+{
+    if ( receivedChar < '0' || receivedChar > '9' ) {
+        pcSerialComStringWrite( "\r\nInvalid temperature\r\n\r\n" );
+        uartMode = UART_MODE_COMMANDS;
+        return;
+    }
+
+    pcSerialComCharWrite( receivedChar );
+    overTempLevelEntered = overTempLevelEntered * 10 + ( receivedChar - '0' );
+    overTempDigitsReceived++;
+    if ( overTempDigitsReceived < 2 ) {
+        return;
+    }
+    uartMode = UART_MODE_COMMANDS;
+
+    if ( overTempLevelWrite( overTempLevelEntered ) != NULL ) {
+        pcSerialComStringWrite( "\r\nInvalid temperature\r\n\r\n" );
+        return;
+    }
+
+    pcSerialComMessageBegin();
+    pcSerialComMessageString( "\r\nMaximum temperature set to " );
+    pcSerialComMessageUnsigned( overTempLevelEntered );
+    pcSerialComMessageString( " \xB0 C\r\n\r\n" );
+    pcSerialComMessageEnd();
+}
+
+// Se llama desde la interrupcion de RX. Solo se encola una activacion de la
+// consola a la vez aunque lleguen varios caracteres seguidos.
+void uartRxNotify()
+{
+    if ( !uartTaskPending ) {
+        uartTaskPending = true;
+        if ( !schedulerPost( SCHEDULER_CONTEXT_CONSOLE, uartTaskRun ) ) {
+            uartTaskPending = false;   // Lo reintenta el proximo caracter recibido
+        }
+    }
+}
+
+void uartTaskRun()
+{
+    uint32_t startCycles = taskTimingStart();
+
+    uartTaskPending = false;
+    uartTask();
+
+    taskTimingStop( uartTimingProbe, startCycles );
+}
+
+// Palabra de estado de la telemetria: bits 0 a 5 los botones segun
+// buttonId_t, bit 6 estado de la alarma. Solo se encola cuando cambia; si
+// la cola esta llena se reintenta en el siguiente tick.
+void statusReportUpdate()
+{
+    uint32_t statusWord = buttonsState | ( alarmFsmIsActive() << BUTTONS_NUMBER );
+
+    if ( statusWord != statusWordQueued &&
+         spscQueuePush( &statusQueue, statusWord ) ) {
+        statusWordQueued = statusWord;
+    }
+}
+
+void telemetryTaskUpdate()
+{
+    static uint32_t statusWord = 0;
+
+    bool statusReceived = false;
+
+    taskSupervisorCheckIn( telemetrySupervisorTask );
+    while ( spscQueuePop( &statusQueue, &statusWord ) ) {
+        telemetryUpdate( statusWord );
+        statusReceived = true;
+    }
+    if ( !statusReceived ) {
+        telemetryUpdate( statusWord );   // Para el modo periodico
+    }
+}
+
+void flashLogSampleUpdate()
+{
+    sensorSnapshot_t snapshot;
+
+    seqlockRead( &sensorSnapshot, &snapshot );
+    flashLogSampleWrite( snapshot.temperatureCentiC, snapshot.gasDetector );
+}
+
+void flashLogEventsUpdate()
+{
+    bool alarmActive = alarmFsmIsActive();
+    bool codeFailed = alarmFsmIncorrectCodeRead();
+    bool keypadLocked = alarmFsmKeypadLocked();
+
+    if ( alarmActive != alarmActiveLogged ) {
+        alarmEventLog( alarmActive ? FLASH_LOG_EVENT_ALARM_ON : FLASH_LOG_EVENT_ALARM_OFF );
+        alarmActiveLogged = alarmActive;
+    }
+    if ( codeFailed && !incorrectCodeLogged ) {
+        alarmEventLog( FLASH_LOG_EVENT_CODE_FAIL );
+    }
+    incorrectCodeLogged = codeFailed;
+    if ( keypadLocked && !keypadLockedLogged ) {
+        alarmEventLog( FLASH_LOG_EVENT_LOCKOUT );
+    }
+    keypadLockedLogged = keypadLocked;
+}
+
+// Cada evento va al log en flash y, con el estado de los detectores, a la
+// telemetria de red; los dos solo encolan, no bloquean al hilo de alarma
+void alarmEventLog( flashLogEvent_t event )
+{
+    uint8_t status = 0;
+
+    if ( alarmFsmIsActive() ) {
+        status |= NET_TELEMETRY_STATUS_ALARM;
+    }
+    if ( gasDetector ) {
+        status |= NET_TELEMETRY_STATUS_GAS;
+    }
+    if ( overTempDetector ) {
+        status |= NET_TELEMETRY_STATUS_OVER_TEMP;
+    }
+
+    flashLogEventWrite( event );
+    netTelemetryEventWrite( event, status );
+}
+
+// Los resumenes se arman con la misma instantanea que lee la consola
+void netTelemetryTaskUpdate()
+{
+    sensorSnapshot_t snapshot;
+
+    seqlockRead( &sensorSnapshot, &snapshot );
+    netTelemetrySampleWrite( snapshot.temperatureCentiC,
+                             snapshot.values[SENSOR_CHANNEL_POTENTIOMETER],
+                             snapshot.gasDetector, alarmFsmIsActive() );
+    netTelemetryUpdate();
+}
+
+// El volcado avanza solo mientras haya lugar en el buffer de TX y se
+// reprograma para seguir cuando la UART lo vacie, o cuando termine el
+// borrado de flash en curso, sin bloquear la consola.
+void flashLogDumpUpdate()
+{
+    flashLogDumpResult_t result = FLASH_LOG_DUMP_LINE_WRITTEN;
+
+    while ( result == FLASH_LOG_DUMP_LINE_WRITTEN &&
+            pcSerialComTxFree() >= FLASH_LOG_LINE_MAX_LENGTH ) {
+        result = flashLogDumpLineWrite();
+        if ( result == FLASH_LOG_DUMP_DONE ) {
+            flashLogDumpActive = false;
+            return;
         }
     }
+    flashLogDumpActive =
+        schedulerPostDelayed( SCHEDULER_CONTEXT_CONSOLE, TIME_INCREMENT_MS, flashLogDumpUpdate );
 }
 
+// El umbral nuevo se aplica en el hilo de alarma y se graba en flash unos
+// segundos despues. La histeresis se recorta si queda mas grande que el
+// umbral. Retorna NULL o el motivo del rechazo, como consoleSetting_t.
+const char* overTempLevelWrite( int celsius )
+{
+    configStoreSettings_t settings = *configStoreRead();
+
+    settings.overTempLevelCentiC = celsius * 100;
+    if ( settings.overTempHysteresisCentiC > settings.overTempLevelCentiC ) {
+        settings.overTempHysteresisCentiC = settings.overTempLevelCentiC;
+    }
+    configStoreWrite( &settings );
+    if ( configStoreRead()->overTempLevelCentiC != celsius * 100 ) {
+        return "invalid temperature";
+    }
+    schedulerPost( SCHEDULER_CONTEXT_ALARM, overTempDetectionInit );
+    return NULL;
+}
+
+// La ayuda sale de las tablas de comandos y se envia de a una linea, como
+// el volcado del log, para no depender del tamaño del buffer de TX. Hay una
+// sola cadena de availableCommandsUpdate() a la vez: pedir la ayuda mientras
+// sale solo la vuelve a empezar, sin ocupar otro lugar en la cola.
 void availableCommands()
 {
-    uartUsb.write( "Available commands:\r\n", 21 );
-    uartUsb.write( "Press '1' to get the alarm state\r\n", 34 );
-    uartUsb.write( "Press '2' to get the gas detector state\r\n", 41 );
-    uartUsb.write( "Press '3' to get the over temperature detector state\r\n", 54 );
-    uartUsb.write( "Press '4' to enter the code sequence\r\n", 38 );
-    uartUsb.write( "Press '5' to enter a new code\r\n", 31 );
-    uartUsb.write( "Press 'P' or 'p' to get potentiometer reading\r\n", 47 );
-    uartUsb.write( "Press 'f' or 'F' to get lm35 reading in Fahrenheit\r\n", 52 );
-    uartUsb.write( "Press 'c' or 'C' to get lm35 reading in Celsius\r\n\r\n", 51 );
+    consoleCommandHelpStart();
+    if ( !availableCommandsActive ) {
+        availableCommandsActive =
+            schedulerPost( SCHEDULER_CONTEXT_CONSOLE, availableCommandsUpdate );
+    }
 }
 
-bool areEqual()
+void availableCommandsUpdate()
 {
+    while ( pcSerialComTxFree() >= CONSOLE_COMMAND_HELP_LINE_MAX_LENGTH ) {
+        if ( !consoleCommandHelpLineWrite() ) {
+            availableCommandsActive = false;
+            return;
+        }
+    }
+    availableCommandsActive =
+        schedulerPostDelayed( SCHEDULER_CONTEXT_CONSOLE, TIME_INCREMENT_MS, availableCommandsUpdate );
+}
+
+// Una linea por tarea: ejecuciones, minimo, promedio y peor tiempo en us,
+// ejecuciones que superaron el presupuesto y el histograma por decadas.
+void taskTimingReportWrite()
+{
+    taskTimingStats_t stats;
     int i;
+    int j;
 
-    for (i = 0; i < NUMBER_OF_KEYS; i++) {
-        if (codeSequence[i] != buttonsPressed[i]) {
-            return false;
+    pcSerialComStringWrite( "Task timing (us): count min avg max budget overruns "
+                            "| <10 <100 <1k <10k <100k more\r\n" );
+    for ( i = 0; i < taskTimingNumberOfProbes(); i++ ) {
+        taskTimingRead( i, &stats );
+
+        pcSerialComMessageBegin();
+        pcSerialComMessageString( stats.name );
+        pcSerialComMessageString( " " );
+        pcSerialComMessageUnsigned( stats.count );
+        pcSerialComMessageString( " " );
+        pcSerialComMessageUnsigned( stats.minUs );
+        pcSerialComMessageString( " " );
+        pcSerialComMessageUnsigned( stats.avgUs );
+        pcSerialComMessageString( " " );
+        pcSerialComMessageUnsigned( stats.maxUs );
+        pcSerialComMessageString( " " );
+        pcSerialComMessageUnsigned( stats.budgetUs );
+        pcSerialComMessageString( " " );
+        pcSerialComMessageUnsigned( stats.overruns );
+        pcSerialComMessageString( " |" );
+        for ( j = 0; j < TASK_TIMING_HISTOGRAM_BUCKETS; j++ ) {
+            pcSerialComMessageString( " " );
+            pcSerialComMessageUnsigned( stats.histogram[j] );
         }
+        pcSerialComMessageString( "\r\n" );
+        pcSerialComMessageEnd();
     }
+}
 
-    return true;
+// Una linea por tarea supervisada: plazo, si es critica, si esta atrasada,
+// plazos perdidos desde el arranque y acumulados en la RAM de backup
+void taskSupervisorReportWrite()
+{
+    taskSupervisorStats_t stats;
+    int lastLateTask = taskSupervisorLastLateTask();
+    int i;
+
+    pcSerialComStringWrite( "Task deadlines (ms): deadline critical late misses total\r\n" );
+    for ( i = 0; i < taskSupervisorNumberOfTasks(); i++ ) {
+        taskSupervisorRead( i, &stats );
+
+        pcSerialComMessageBegin();
+        pcSerialComMessageString( stats.name );
+        pcSerialComMessageString( " " );
+        pcSerialComMessageUnsigned( stats.deadlineMs );
+        pcSerialComMessageString( stats.critical ? " yes" : " no" );
+        pcSerialComMessageString( stats.late ? " yes " : " no " );
+        pcSerialComMessageUnsigned( stats.misses );
+        pcSerialComMessageString( " " );
+        pcSerialComMessageUnsigned( stats.totalMisses );
+        pcSerialComMessageString( "\r\n" );
+        pcSerialComMessageEnd();
+    }
+
+    pcSerialComMessageBegin();
+    pcSerialComMessageString( "Watchdog resets: " );
+    pcSerialComMessageUnsigned( taskSupervisorWatchdogResets() );
+    pcSerialComMessageString( ", dropped posts: " );
+    pcSerialComMessageUnsigned( schedulerDroppedPosts() );
+    pcSerialComMessageString( ", last late critical task: " );
+    pcSerialComMessageString( taskSupervisorRead( lastLateTask, &stats ) ? stats.name : "none" );
+    pcSerialComMessageString( TASK_SUPERVISOR_WATCHDOG_TIMEOUT_MS > 0 ?
+                              "\r\n" : ", watchdog disabled\r\n" );
+    pcSerialComMessageEnd();
+}
+
+void netTelemetryReportWrite()
+{
+    netTelemetryStats_t stats;
+
+    netTelemetryRead( &stats );
+    pcSerialComMessageBegin();
+    pcSerialComMessageString( "Network telemetry: " );
+    pcSerialComMessageString( netTelemetryStateName( stats.state ) );
+    if ( stats.state != NET_TELEMETRY_STATE_OFF ) {
+        pcSerialComMessageString( ", collector " NET_TELEMETRY_COLLECTOR ":" );
+        pcSerialComMessageUnsigned( NET_TELEMETRY_PORT );
+    }
+    pcSerialComMessageString( ", messages: " );
+    pcSerialComMessageUnsigned( stats.messagesSent );
+    pcSerialComMessageString( ", send errors: " );
+    pcSerialComMessageUnsigned( stats.sendErrors );
+    pcSerialComMessageString( ", connections: " );
+    pcSerialComMessageUnsigned( stats.connections );
+    pcSerialComMessageString( ", dropped events: " );
+    pcSerialComMessageUnsigned( stats.droppedEvents );
+    pcSerialComMessageString( ", dropped summaries: " );
+    pcSerialComMessageUnsigned( stats.droppedSummaries );
+    pcSerialComMessageString( "\r\n" );
+    pcSerialComMessageEnd();
+}
+
+void taskSupervisorClear()
+{
+    taskSupervisorReset();
+    pcSerialComStringWrite( "Task deadline counters cleared\r\n" );
+}
+
+// Una linea por detector e intervalo medido: mediciones, minimo, p50, p95,
+// p99 y peor latencia en us. Los percentiles son de las ultimas mediciones.
+void alarmLatencyReportWrite()
+{
+    alarmLatencyStats_t stats;
+    int source;
+    int interval;
+
+    pcSerialComStringWrite( ALARM_LATENCY_PROBES ?
+                            "Alarm latency (us): count min p50 p95 p99 max\r\n" :
+                            "Alarm latency probes are disabled\r\n" );
+    for ( source = 0; source < ALARM_LATENCY_NUMBER_OF_SOURCES; source++ ) {
+        for ( interval = 0; interval < ALARM_LATENCY_NUMBER_OF_INTERVALS; interval++ ) {
+            if ( !alarmLatencyRead( (alarmLatencySource_t) source,
+                                    (alarmLatencyInterval_t) interval, &stats ) ) {
+                continue;
+            }
+
+            pcSerialComMessageBegin();
+            pcSerialComMessageString( alarmLatencySourceName( (alarmLatencySource_t) source ) );
+            pcSerialComMessageString( " " );
+            pcSerialComMessageString(
+                alarmLatencyIntervalName( (alarmLatencyInterval_t) interval ) );
+            pcSerialComMessageString( " " );
+            pcSerialComMessageUnsigned( stats.count );
+            pcSerialComMessageString( " " );
+            pcSerialComMessageUnsigned( stats.minUs );
+            pcSerialComMessageString( " " );
+            pcSerialComMessageUnsigned( stats.p50Us );
+            pcSerialComMessageString( " " );
+            pcSerialComMessageUnsigned( stats.p95Us );
+            pcSerialComMessageString( " " );
+            pcSerialComMessageUnsigned( stats.p99Us );
+            pcSerialComMessageString( " " );
+            pcSerialComMessageUnsigned( stats.maxUs );
+            pcSerialComMessageString( "\r\n" );
+            pcSerialComMessageEnd();
+        }
+    }
+}
+
+// Una linea por canal: nombre, zona, valor del ultimo lote (con su velocidad
+// de subida si es de temperatura) y si detecta
+void sensorChannelsReportWrite()
+{
+    sensorSnapshot_t snapshot;
+    sensorChannel_t channel;
+    int i;
+
+    seqlockRead( &sensorSnapshot, &snapshot );
+
+    for ( i = 0; i < SENSOR_NUMBER_OF_CHANNELS; i++ ) {
+        channel = (sensorChannel_t) i;
+
+        pcSerialComMessageBegin();
+        pcSerialComMessageString( sensorRegistryName( channel ) );
+        pcSerialComMessageString( " zone " );
+        pcSerialComMessageUnsigned( sensorRegistryZone( channel ) );
+        pcSerialComMessageString( ": " );
+        if ( sensorRegistryKind( channel ) == SENSOR_KIND_TEMPERATURE ) {
+            pcSerialComMessageCentesimal(
+                analogReadingScaledWithTheLM35Formula( snapshot.values[channel] ) );
+            pcSerialComMessageString( " \xB0 C, rising " );
+            pcSerialComMessageCentesimal( snapshot.rises[channel] *
+                                          LM35_CENTI_DEGREES_FULL_SCALE / ADC_FULL_SCALE );
+            pcSerialComMessageString( " \xB0 C/s" );
+        } else {
+            pcSerialComMessageUnsigned( snapshot.values[channel] );
+        }
+        pcSerialComMessageString( ( snapshot.activeChannels & SENSOR_CHANNEL_MASK( channel ) ) ?
+                                  " active\r\n" : "\r\n" );
+        pcSerialComMessageEnd();
+    }
+}
+
+bool areEqual( uint32_t code )
+{
+    return configStoreCodeMatches( code & CODE_SEQUENCE_MASK );
+}
+
+// Las temperaturas se manejan en centesimas de grado con aritmetica entera:
+// el producto maximo (65535 * 33000) entra en 32 bits sin signo.
+int analogReadingScaledWithTheLM35Formula( uint16_t analogReading )
+{
+    return ( (uint32_t) analogReading * LM35_CENTI_DEGREES_FULL_SCALE + ADC_FULL_SCALE / 2 )
+           / ADC_FULL_SCALE;
 }
 
-float analogReadingScaledWithTheLM35Formula( float analogReading )
+int celsiusToFahrenheit( int tempInCelsiusDegrees )
 {
-    return ( analogReading * 3.3 / 0.01 );
+    return ( tempInCelsiusDegrees * 9 / 5 + 3200 );
 }
 
-float celsiusToFahrenheit( float tempInCelsiusDegrees )
+// Posicion del potenciometro entre 0.00 y 1.00, en centesimas
+int potentiometerCentesimal( uint16_t reading )
 {
-    return ( tempInCelsiusDegrees * 9.0 / 5.0 + 32.0 );
+    return ( reading * 100 + ADC_FULL_SCALE / 2 ) / ADC_FULL_SCALE;
 }
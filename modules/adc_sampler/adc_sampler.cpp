@@ -0,0 +1,224 @@
+//=====[Libraries]=============================================================
+
+#include "mbed.h"
+#include "arm_book_lib.h"
+
+#include "adc_sampler.h"
+#include "task_timing.h"
+
+//=====[Declaration of private defines]========================================
+
+#define ADC_SAMPLER_BUFFER_MASK    ( ADC_SAMPLER_BUFFER_SIZE - 1 )
+
+//=====[Declaration and initialization of private global objects]==============
+
+// Se usan los objetos de la capa HAL en lugar de AnalogIn porque
+// AnalogIn::read() toma un mutex y no puede llamarse desde la interrupcion
+// del timer. Por la misma razon, y porque la cantidad de entradas recien se
+// conoce en adcSamplerInit(), las digitales usan gpio_t y gpio_irq_t en
+// lugar de InterruptIn.
+static analogin_t adcSamplerAnalogInputs[ADC_SAMPLER_MAX_ANALOG];
+static gpio_t adcSamplerDigitalInputs[ADC_SAMPLER_MAX_DIGITAL];
+
+// Los flancos de las entradas digitales despiertan al sistema sin esperar a
+// la proxima muestra
+static gpio_irq_t adcSamplerDigitalIrqs[ADC_SAMPLER_MAX_DIGITAL];
+
+#if MBED_CONF_APP_LOW_POWER_MODE
+// LowPowerTicker no bloquea el deep sleep entre muestras, a costa de una
+// resolucion de tiempo mas gruesa
+static LowPowerTicker adcSamplerTicker;
+#else
+static Ticker adcSamplerTicker;
+#endif
+
+//=====[Declaration and initialization of private global variables]============
+
+// Buffer circular de un productor (ISR) y un consumidor (loop principal).
+// Cada lado modifica solo su propio indice, por lo que no hace falta lock.
+static adcSample_t adcSamplerBuffer[ADC_SAMPLER_BUFFER_SIZE];
+static volatile uint32_t adcSamplerHead = 0;
+static volatile uint32_t adcSamplerTail = 0;
+static volatile uint32_t adcSamplerOverrunCount = 0;
+
+static int adcSamplerNumberOfAnalog = 0;
+static int adcSamplerOversampling[ADC_SAMPLER_MAX_ANALOG];   // Conversiones por muestra
+static int adcSamplerNumberOfDigital = 0;
+
+// Instante del ultimo flanco de cada entrada digital, tomado en la
+// interrupcion como lo haria una captura de entrada
+static volatile uint32_t adcSamplerDigitalEdgeCycles[ADC_SAMPLER_MAX_DIGITAL];
+
+static adcSamplerDigitalCallback_t adcSamplerDigitalCallback = NULL;
+
+//=====[Declarations (prototypes) of private functions]========================
+
+static void adcSamplerIsr();
+static void adcSamplerDigitalEdgeIsr( uintptr_t context, gpio_irq_event event );
+
+//=====[Implementations of public functions]===================================
+
+// Las entradas que excedan ADC_SAMPLER_MAX_ANALOG o ADC_SAMPLER_MAX_DIGITAL
+// se ignoran. analogOversampling indica cuantas conversiones seguidas se
+// promedian en cada muestra de la entrada analogica i, hasta
+// ADC_SAMPLER_MAX_OVERSAMPLING; con NULL se toma una sola. El F429 no tiene
+// sobremuestreo por hardware, asi que se hace en la interrupcion del timer:
+// el promedio se guarda en la escala de 16 bits sin redondear a los 12 del
+// ADC, y con 4^k conversiones el ruido blanco baja como con k bits mas.
+void adcSamplerInit( const PinName* analogPins, const int* analogOversampling,
+                     int numberOfAnalogInputs, const PinName* digitalPins,
+                     int numberOfDigitalInputs,
+                     adcSamplerDigitalCallback_t digitalEdgeCallback )
+{
+    int i;
+
+    adcSamplerNumberOfAnalog = numberOfAnalogInputs < ADC_SAMPLER_MAX_ANALOG ?
+                               numberOfAnalogInputs : ADC_SAMPLER_MAX_ANALOG;
+    adcSamplerNumberOfDigital = numberOfDigitalInputs < ADC_SAMPLER_MAX_DIGITAL ?
+                                numberOfDigitalInputs : ADC_SAMPLER_MAX_DIGITAL;
+
+    for ( i = 0; i < adcSamplerNumberOfAnalog; i++ ) {
+        analogin_init( &adcSamplerAnalogInputs[i], analogPins[i] );
+        adcSamplerOversampling[i] = analogOversampling != NULL ? analogOversampling[i] : 1;
+        if ( adcSamplerOversampling[i] < 1 ) {
+            adcSamplerOversampling[i] = 1;
+        } else if ( adcSamplerOversampling[i] > ADC_SAMPLER_MAX_OVERSAMPLING ) {
+            adcSamplerOversampling[i] = ADC_SAMPLER_MAX_OVERSAMPLING;
+        }
+    }
+
+    adcSamplerDigitalCallback = digitalEdgeCallback;
+    for ( i = 0; i < adcSamplerNumberOfDigital; i++ ) {
+        adcSamplerDigitalEdgeCycles[i] = taskTimingStart();
+        gpio_init_in( &adcSamplerDigitalInputs[i], digitalPins[i] );
+        gpio_irq_init( &adcSamplerDigitalIrqs[i], digitalPins[i],
+                       &adcSamplerDigitalEdgeIsr, (uintptr_t) i );
+        gpio_irq_set( &adcSamplerDigitalIrqs[i], IRQ_RISE, 1 );
+        gpio_irq_set( &adcSamplerDigitalIrqs[i], IRQ_FALL, 1 );
+        gpio_irq_enable( &adcSamplerDigitalIrqs[i] );
+    }
+
+    adcSamplerTicker.attach( &adcSamplerIsr,
+                             std::chrono::microseconds( 1000000 / ADC_SAMPLER_RATE_HZ ) );
+}
+
+// Entrega hasta maxSamples muestras en orden de adquisicion y devuelve
+// cuantas se copiaron.
+int adcSamplerRead( adcSample_t* samples, int maxSamples )
+{
+    uint32_t tail = adcSamplerTail;
+    uint32_t head = adcSamplerHead;
+    int count = 0;
+
+    while ( tail != head && count < maxSamples ) {
+        samples[count] = adcSamplerBuffer[tail & ADC_SAMPLER_BUFFER_MASK];
+        tail++;
+        count++;
+    }
+    adcSamplerTail = tail;
+
+    return count;
+}
+
+// Promedio de numberOfReadings conversiones seguidas de cada entrada
+// analogica, sin esperar al timer: para cargar los filtros al arrancar. Cada
+// conversion va en una seccion critica porque la interrupcion del timer usa
+// el mismo ADC.
+void adcSamplerBurstRead( adcSample_t* sample, int numberOfReadings )
+{
+    uint32_t sums[ADC_SAMPLER_MAX_ANALOG];
+    int reading;
+    int i;
+
+    if ( numberOfReadings < 1 ) {
+        numberOfReadings = 1;
+    }
+
+    memset( sums, 0, sizeof( sums ) );
+    for ( reading = 0; reading < numberOfReadings; reading++ ) {
+        for ( i = 0; i < adcSamplerNumberOfAnalog; i++ ) {
+            core_util_critical_section_enter();
+            sums[i] += analogin_read_u16( &adcSamplerAnalogInputs[i] );
+            core_util_critical_section_exit();
+        }
+    }
+
+    memset( sample, 0, sizeof( *sample ) );
+    for ( i = 0; i < adcSamplerNumberOfAnalog; i++ ) {
+        sample->analog[i] = ( sums[i] + numberOfReadings / 2 ) / numberOfReadings;
+    }
+    sample->digital = adcSamplerDigitalRead();
+    sample->cycles = taskTimingStart();
+}
+
+// Nivel actual de las entradas digitales, un bit por entrada
+uint32_t adcSamplerDigitalRead()
+{
+    uint32_t levels = 0;
+    int i;
+
+    for ( i = 0; i < adcSamplerNumberOfDigital; i++ ) {
+        levels |= (uint32_t) ( gpio_read( &adcSamplerDigitalInputs[i] ) != 0 ) << i;
+    }
+
+    return levels;
+}
+
+// Instante del ultimo flanco de la entrada, de subida o de bajada: es el
+// que la llevo al nivel que tiene ahora
+uint32_t adcSamplerDigitalEdgeCyclesRead( int input )
+{
+    if ( input < 0 || input >= adcSamplerNumberOfDigital ) {
+        return 0;
+    }
+    return adcSamplerDigitalEdgeCycles[input];
+}
+
+uint32_t adcSamplerOverruns()
+{
+    return adcSamplerOverrunCount;
+}
+
+//=====[Implementations of private functions]==================================
+
+static void adcSamplerIsr()
+{
+    uint32_t head = adcSamplerHead;
+
+    if ( head - adcSamplerTail >= ADC_SAMPLER_BUFFER_SIZE ) {
+        adcSamplerOverrunCount++;   // El consumidor se atraso: se descarta la muestra
+        return;
+    }
+
+    adcSample_t* sample = &adcSamplerBuffer[head & ADC_SAMPLER_BUFFER_MASK];
+    uint32_t sum;
+    int conversions;
+    int conversion;
+    int i;
+
+    sample->cycles = taskTimingStart();
+    for ( i = 0; i < adcSamplerNumberOfAnalog; i++ ) {
+        conversions = adcSamplerOversampling[i];
+        if ( conversions == 1 ) {
+            sample->analog[i] = analogin_read_u16( &adcSamplerAnalogInputs[i] );
+            continue;
+        }
+        sum = 0;
+        for ( conversion = 0; conversion < conversions; conversion++ ) {
+            sum += analogin_read_u16( &adcSamplerAnalogInputs[i] );
+        }
+        sample->analog[i] = ( sum + conversions / 2 ) / conversions;
+    }
+    sample->digital = adcSamplerDigitalRead();
+
+    adcSamplerHead = head + 1;
+}
+
+static void adcSamplerDigitalEdgeIsr( uintptr_t context, gpio_irq_event event )
+{
+    adcSamplerDigitalEdgeCycles[context] = taskTimingStart();
+
+    if ( adcSamplerDigitalCallback != NULL ) {
+        adcSamplerDigitalCallback();
+    }
+}
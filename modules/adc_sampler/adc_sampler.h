@@ -0,0 +1,56 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _ADC_SAMPLER_H_
+#define _ADC_SAMPLER_H_
+
+//=====[Libraries]=============================================================
+
+#include "mbed.h"
+#include <stdint.h>
+
+//=====[Declaration of public defines]=========================================
+
+#ifdef MBED_CONF_APP_ADC_SAMPLE_RATE_HZ
+#define ADC_SAMPLER_RATE_HZ          MBED_CONF_APP_ADC_SAMPLE_RATE_HZ
+#else
+#define ADC_SAMPLER_RATE_HZ          1000
+#endif
+#ifdef MBED_CONF_APP_ADC_OVERSAMPLING
+#define ADC_SAMPLER_OVERSAMPLING     MBED_CONF_APP_ADC_OVERSAMPLING
+#else
+#define ADC_SAMPLER_OVERSAMPLING     4
+#endif
+#define ADC_SAMPLER_MAX_OVERSAMPLING  64   // La suma de las conversiones entra en 32 bits
+#define ADC_SAMPLER_BUFFER_SIZE       256   // Potencia de 2
+// Cada entrada analogica agranda todas las muestras (y el buffer de
+// ADC_SAMPLER_BUFFER_SIZE); alcanza para los canales de sensor_registry,
+// cuyo static_assert avisa si una zona nueva necesita mas
+#define ADC_SAMPLER_MAX_ANALOG          4
+#define ADC_SAMPLER_MAX_DIGITAL        16
+
+//=====[Declaration of public data types]======================================
+
+// Una adquisicion completa tomada en el mismo instante del timer, con las
+// entradas en el orden en que se pasaron a adcSamplerInit()
+typedef struct {
+    uint16_t analog[ADC_SAMPLER_MAX_ANALOG];   // Lecturas escaladas a 16 bits, ver adcSamplerInit()
+    uint16_t digital;                          // Bit i: nivel de la entrada digital i
+    uint32_t cycles;                           // Instante de la adquisicion, ver taskTimingStart()
+} adcSample_t;
+
+typedef void (*adcSamplerDigitalCallback_t)();
+
+//=====[Declarations (prototypes) of public functions]=========================
+
+void adcSamplerInit( const PinName* analogPins, const int* analogOversampling,
+                     int numberOfAnalogInputs, const PinName* digitalPins, int numberOfDigitalInputs,
+                     adcSamplerDigitalCallback_t digitalEdgeCallback );
+void adcSamplerBurstRead( adcSample_t* sample, int numberOfReadings );
+uint32_t adcSamplerDigitalRead();
+uint32_t adcSamplerDigitalEdgeCyclesRead( int input );
+int adcSamplerRead( adcSample_t* samples, int maxSamples );
+uint32_t adcSamplerOverruns();
+
+//=====[#include guards - end]=================================================
+
+#endif // _ADC_SAMPLER_H_
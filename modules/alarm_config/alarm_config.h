@@ -0,0 +1,78 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _ALARM_CONFIG_H_
+#define _ALARM_CONFIG_H_
+
+//=====[Libraries]=============================================================
+
+#include <stdint.h>
+
+//=====[Declaration of public defines]=========================================
+
+// Perfiles disponibles para "alarm-profile" en mbed_app.json
+#define ALARM_PROFILE_DEFAULT          0
+#define ALARM_PROFILE_FAST_RESPONSE    1
+#define ALARM_PROFILE_HIGH_TEMP        2
+
+#ifndef MBED_CONF_APP_ALARM_PROFILE
+#define MBED_CONF_APP_ALARM_PROFILE    ALARM_PROFILE_DEFAULT
+#endif
+
+// Bits de detectores activos usados como indice de blinkingTimeMs[]
+#define ALARM_DETECTOR_GAS             ( 1 << 0 )
+#define ALARM_DETECTOR_OVER_TEMP       ( 1 << 1 )
+
+//=====[Declaration of public data types]======================================
+
+// Configuracion de la alarma resuelta en tiempo de compilacion. Cada
+// variante de equipo es una instancia distinta de la plantilla, por lo que
+// los umbrales y tamaños quedan como constantes en el codigo generado.
+template <int overTempLevelC, int avgSamples, int keys,
+          uint32_t gasBlinkMs, uint32_t overTempBlinkMs, uint32_t bothBlinkMs,
+          int hysteresisCentiC, int riseRateCentiCPerS>
+struct alarmConfig_t {
+    static constexpr int overTempLevel      = overTempLevelC;   // En grados Celsius
+    // El detector de temperatura se apaga recien al bajar overTempHysteresis
+    // centesimas de grado por debajo de overTempLevel
+    static constexpr int overTempHysteresis = hysteresisCentiC;
+    // Subida del promedio, en centesimas de grado por segundo, que activa el
+    // detector aunque no se llegue a overTempLevel; 0 la deshabilita
+    static constexpr int overTempRiseRate   = riseRateCentiCPerS;
+    static constexpr int numberOfAvgSamples = avgSamples;
+    static constexpr int numberOfKeys       = keys;
+
+    // Periodo de parpadeo indexado por ALARM_DETECTOR_GAS | ALARM_DETECTOR_OVER_TEMP.
+    // 0 indica que no hay detector activo y el led no parpadea.
+    static constexpr uint32_t blinkingTimeMs[4] = {
+        0, gasBlinkMs, overTempBlinkMs, bothBlinkMs
+    };
+
+    static_assert( keys >= 1 && keys <= 4, "El teclado tiene cuatro teclas de codigo (A a D)" );
+    static_assert( avgSamples >= 1 && avgSamples <= 65536, "Ventana fuera del rango de movingAverage_t" );
+    static_assert( hysteresisCentiC >= 0 && hysteresisCentiC <= overTempLevelC * 100,
+                   "La histeresis no puede superar el umbral" );
+    static_assert( riseRateCentiCPerS >= 0, "La velocidad de subida no puede ser negativa" );
+};
+
+template <int overTempLevelC, int avgSamples, int keys,
+          uint32_t gasBlinkMs, uint32_t overTempBlinkMs, uint32_t bothBlinkMs,
+          int hysteresisCentiC, int riseRateCentiCPerS>
+constexpr uint32_t alarmConfig_t<overTempLevelC, avgSamples, keys, gasBlinkMs,
+                                 overTempBlinkMs, bothBlinkMs, hysteresisCentiC,
+                                 riseRateCentiCPerS>::blinkingTimeMs[4];
+
+// Conversiones del ADC promediadas. Con ADC_SAMPLER_OVERSAMPLING en 4 y
+// ADC_SAMPLER_RATE_HZ en 1000, 1000 conversiones son 250 muestras: 250 ms.
+// Histeresis en centesimas de grado, subida en centesimas de grado por segundo.
+//                    Temp  Conver.  Teclas  Gas   Temp  Ambos Histeresis Subida
+#if MBED_CONF_APP_ALARM_PROFILE == ALARM_PROFILE_FAST_RESPONSE
+typedef alarmConfig_t<  50,     250,     4, 1000,  500,  100,       200,   100 > alarmConfig;
+#elif MBED_CONF_APP_ALARM_PROFILE == ALARM_PROFILE_HIGH_TEMP
+typedef alarmConfig_t<  70,    1000,     4, 1000,  500,  100,       300,   300 > alarmConfig;
+#else
+typedef alarmConfig_t<  50,    1000,     4, 1000,  500,  100,       200,   200 > alarmConfig;
+#endif
+
+//=====[#include guards - end]=================================================
+
+#endif // _ALARM_CONFIG_H_
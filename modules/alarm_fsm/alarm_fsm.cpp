@@ -0,0 +1,249 @@
+//=====[Libraries]=============================================================
+
+#include "mbed.h"
+#include "arm_book_lib.h"
+
+#include "alarm_fsm.h"
+#include "alarm_config.h"
+#include "config_store.h"
+#include "alarm_output.h"
+#include "alarm_latency.h"
+
+//=====[Declaration of private defines]========================================
+
+#define ALARM_FSM_EVENT_QUEUE_MASK    ( ALARM_FSM_EVENT_QUEUE_SIZE - 1 )
+
+//=====[Declaration of private data types]=====================================
+
+typedef void (*alarmFsmAction_t)();
+
+typedef struct {
+    alarmState_t nextState;
+    alarmFsmAction_t action;    // NULL: el evento se ignora en ese estado
+} alarmFsmTransition_t;
+
+typedef struct {
+    alarmFsmAction_t entry;
+    alarmFsmAction_t exit;
+} alarmFsmStateActions_t;
+
+//=====[Declarations (prototypes) of private functions]========================
+
+static void alarmFsmEventProcess( alarmEvent_t event );
+static void alarmFsmOutputsRefresh();
+
+static void alarmFsmIdleEntry();
+static void alarmFsmActiveEntry();
+static void alarmFsmGasDetected();
+static void alarmFsmOverTempDetected();
+static void alarmFsmTestActivated();
+static void alarmFsmCodeOk();
+static void alarmFsmCodeFail();
+static void alarmFsmIncorrectCodeClear();
+static void alarmFsmLockout();
+
+//=====[Declaration and initialization of private global variables]============
+
+// Tabla de transiciones indexada por [estado][evento]
+static const alarmFsmTransition_t
+alarmFsmTransitions[ALARM_NUMBER_OF_STATES][ALARM_NUMBER_OF_EVENTS] = {
+    // ALARM_STATE_IDLE
+    {
+        { ALARM_STATE_ACTIVE, alarmFsmGasDetected },          // GAS
+        { ALARM_STATE_ACTIVE, alarmFsmOverTempDetected },     // OVER_TEMP
+        { ALARM_STATE_ACTIVE, alarmFsmTestActivated },        // TEST
+        { ALARM_STATE_IDLE,   alarmFsmCodeOk },               // CODE_OK
+        { ALARM_STATE_IDLE,   alarmFsmCodeFail },             // CODE_FAIL
+        { ALARM_STATE_IDLE,   alarmFsmIncorrectCodeClear },   // INCORRECT_CODE_CLEAR
+        { ALARM_STATE_IDLE,   alarmFsmLockout },              // LOCKOUT
+    },
+    // ALARM_STATE_ACTIVE
+    {
+        { ALARM_STATE_ACTIVE, alarmFsmGasDetected },          // GAS
+        { ALARM_STATE_ACTIVE, alarmFsmOverTempDetected },     // OVER_TEMP
+        { ALARM_STATE_ACTIVE, alarmFsmTestActivated },        // TEST
+        { ALARM_STATE_IDLE,   alarmFsmCodeOk },               // CODE_OK
+        { ALARM_STATE_ACTIVE, alarmFsmCodeFail },             // CODE_FAIL
+        { ALARM_STATE_ACTIVE, alarmFsmIncorrectCodeClear },   // INCORRECT_CODE_CLEAR
+        { ALARM_STATE_ACTIVE, alarmFsmLockout },              // LOCKOUT
+    },
+};
+
+static const alarmFsmStateActions_t alarmFsmStateActions[ALARM_NUMBER_OF_STATES] = {
+    { alarmFsmIdleEntry,   NULL },  // ALARM_STATE_IDLE
+    { alarmFsmActiveEntry, NULL },  // ALARM_STATE_ACTIVE
+};
+
+// Todo el estado de la alarma vive aca y solo lo modifica alarmFsmUpdate(),
+// por lo que los eventos pueden publicarse desde cualquier contexto.
+static alarmState_t alarmFsmState = ALARM_STATE_IDLE;
+static uint32_t alarmFsmDetectors = 0;          // ALARM_DETECTOR_GAS | ALARM_DETECTOR_OVER_TEMP
+static bool alarmFsmIncorrectCode = false;
+static int alarmFsmNumberOfIncorrectCodes = 0;
+
+static alarmEvent_t alarmFsmEventQueue[ALARM_FSM_EVENT_QUEUE_SIZE];
+static uint32_t alarmFsmEventHead = 0;
+static uint32_t alarmFsmEventTail = 0;
+
+static alarmFsmEventCallback_t alarmFsmEventCallback = NULL;
+
+//=====[Implementations of public functions]===================================
+
+void alarmFsmInit( alarmFsmEventCallback_t eventCallback )
+{
+    alarmFsmEventCallback = eventCallback;
+    alarmFsmState = ALARM_STATE_IDLE;
+    alarmFsmIdleEntry();
+}
+
+// Puede llamarse desde cualquier tarea o interrupcion; el evento se procesa
+// despues en alarmFsmUpdate().
+void alarmFsmEventPost( alarmEvent_t event )
+{
+    bool queued = false;
+
+    core_util_critical_section_enter();
+    if ( alarmFsmEventHead - alarmFsmEventTail < ALARM_FSM_EVENT_QUEUE_SIZE ) {
+        alarmFsmEventQueue[alarmFsmEventHead & ALARM_FSM_EVENT_QUEUE_MASK] = event;
+        alarmFsmEventHead++;
+        queued = true;
+    }
+    core_util_critical_section_exit();
+
+    if ( queued && alarmFsmEventCallback != NULL ) {
+        alarmFsmEventCallback();
+    }
+}
+
+void alarmFsmUpdate()
+{
+    alarmEvent_t event;
+    bool pending;
+
+    do {
+        core_util_critical_section_enter();
+        pending = alarmFsmEventTail != alarmFsmEventHead;
+        if ( pending ) {
+            event = alarmFsmEventQueue[alarmFsmEventTail & ALARM_FSM_EVENT_QUEUE_MASK];
+            alarmFsmEventTail++;
+        }
+        core_util_critical_section_exit();
+
+        if ( pending ) {
+            alarmFsmEventProcess( event );
+        }
+    } while ( pending );
+}
+
+alarmState_t alarmFsmStateRead()
+{
+    return alarmFsmState;
+}
+
+bool alarmFsmIsActive()
+{
+    return alarmFsmState == ALARM_STATE_ACTIVE;
+}
+
+uint32_t alarmFsmDetectorsRead()
+{
+    return alarmFsmDetectors;
+}
+
+bool alarmFsmIncorrectCodeRead()
+{
+    return alarmFsmIncorrectCode;
+}
+
+bool alarmFsmKeypadLocked()
+{
+    return alarmFsmNumberOfIncorrectCodes >= ALARM_FSM_CODE_ATTEMPTS_LIMIT;
+}
+
+//=====[Implementations of private functions]==================================
+
+// Las acciones de salida y entrada solo corren cuando el estado cambia; en
+// una transicion al mismo estado solo corre la accion de la transicion.
+static void alarmFsmEventProcess( alarmEvent_t event )
+{
+    const alarmFsmTransition_t* transition = &alarmFsmTransitions[alarmFsmState][event];
+
+    if ( transition->action == NULL ) {
+        return;
+    }
+
+    if ( transition->nextState != alarmFsmState ) {
+        if ( alarmFsmStateActions[alarmFsmState].exit != NULL ) {
+            alarmFsmStateActions[alarmFsmState].exit();
+        }
+        transition->action();
+        alarmFsmState = transition->nextState;
+        if ( alarmFsmStateActions[alarmFsmState].entry != NULL ) {
+            alarmFsmStateActions[alarmFsmState].entry();
+        }
+    } else {
+        transition->action();
+    }
+
+    alarmFsmOutputsRefresh();
+}
+
+static void alarmFsmOutputsRefresh()
+{
+    alarmOutputUpdate( alarmFsmState == ALARM_STATE_ACTIVE,
+                       configStoreRead()->blinkingTimeMs[alarmFsmDetectors] );
+}
+
+static void alarmFsmIdleEntry()
+{
+    alarmFsmDetectors = 0;
+}
+
+static void alarmFsmActiveEntry()
+{
+    alarmLatencyStateMark();
+}
+
+static void alarmFsmGasDetected()
+{
+    alarmFsmDetectors |= ALARM_DETECTOR_GAS;
+}
+
+static void alarmFsmOverTempDetected()
+{
+    alarmFsmDetectors |= ALARM_DETECTOR_OVER_TEMP;
+}
+
+static void alarmFsmTestActivated()
+{
+    alarmFsmDetectors |= ALARM_DETECTOR_GAS | ALARM_DETECTOR_OVER_TEMP;
+}
+
+static void alarmFsmCodeOk()
+{
+    alarmFsmNumberOfIncorrectCodes = 0;
+    alarmFsmIncorrectCode = false;
+    alarmOutputIncorrectCodeWrite( OFF );
+}
+
+static void alarmFsmCodeFail()
+{
+    alarmFsmNumberOfIncorrectCodes++;
+    alarmFsmIncorrectCode = true;
+    alarmOutputIncorrectCodeWrite( ON );
+
+    if ( alarmFsmNumberOfIncorrectCodes == ALARM_FSM_CODE_ATTEMPTS_LIMIT ) {
+        alarmFsmEventPost( ALARM_EVENT_LOCKOUT );
+    }
+}
+
+static void alarmFsmIncorrectCodeClear()
+{
+    alarmFsmIncorrectCode = false;
+    alarmOutputIncorrectCodeWrite( OFF );
+}
+
+static void alarmFsmLockout()
+{
+    alarmOutputSystemBlockedWrite( ON );
+}
@@ -0,0 +1,50 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _ALARM_FSM_H_
+#define _ALARM_FSM_H_
+
+//=====[Libraries]=============================================================
+
+#include <stdint.h>
+
+//=====[Declaration of public defines]=========================================
+
+#define ALARM_FSM_CODE_ATTEMPTS_LIMIT    5    // Intentos fallidos hasta bloquear el teclado
+#define ALARM_FSM_EVENT_QUEUE_SIZE      16    // Potencia de 2
+
+//=====[Declaration of public data types]======================================
+
+typedef enum {
+    ALARM_STATE_IDLE,           // Alarma apagada
+    ALARM_STATE_ACTIVE,         // Sirena y led de alarma encendidos
+    ALARM_NUMBER_OF_STATES,
+} alarmState_t;
+
+typedef enum {
+    ALARM_EVENT_GAS,                    // El MQ-2 detecta gas
+    ALARM_EVENT_OVER_TEMP,              // La temperatura supera el umbral
+    ALARM_EVENT_TEST,                   // Boton de prueba presionado
+    ALARM_EVENT_CODE_OK,                // Se ingreso el codigo correcto
+    ALARM_EVENT_CODE_FAIL,              // Se ingreso un codigo incorrecto
+    ALARM_EVENT_INCORRECT_CODE_CLEAR,   // A+B+C+D sin Enter: apaga el led de incorrecto
+    ALARM_EVENT_LOCKOUT,                // Se agotaron los intentos
+    ALARM_NUMBER_OF_EVENTS,
+} alarmEvent_t;
+
+typedef void (*alarmFsmEventCallback_t)();
+
+//=====[Declarations (prototypes) of public functions]=========================
+
+void alarmFsmInit( alarmFsmEventCallback_t eventCallback );
+void alarmFsmEventPost( alarmEvent_t event );
+void alarmFsmUpdate();
+
+alarmState_t alarmFsmStateRead();
+bool alarmFsmIsActive();
+uint32_t alarmFsmDetectorsRead();
+bool alarmFsmIncorrectCodeRead();
+bool alarmFsmKeypadLocked();
+
+//=====[#include guards - end]=================================================
+
+#endif // _ALARM_FSM_H_
@@ -0,0 +1,211 @@
+//=====[Libraries]=============================================================
+
+#include "mbed.h"
+#include "arm_book_lib.h"
+
+#include "alarm_latency.h"
+#include "task_timing.h"
+
+//=====[Declaration of private data types]=====================================
+
+// Las latencias se guardan en ciclos y se pasan a microsegundos al leerlas
+typedef struct {
+    uint32_t count;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint32_t history[ALARM_LATENCY_HISTORY];   // Buffer circular, indice count
+} alarmLatencyRecord_t;
+
+//=====[Declaration and initialization of private global variables]============
+
+static alarmLatencyRecord_t
+alarmLatencyRecords[ALARM_LATENCY_NUMBER_OF_SOURCES][ALARM_LATENCY_NUMBER_OF_INTERVALS];
+
+static const char* const alarmLatencySourceNames[ALARM_LATENCY_NUMBER_OF_SOURCES] = {
+    "gas",
+    "over_temp",
+};
+
+static const char* const alarmLatencyIntervalNames[ALARM_LATENCY_NUMBER_OF_INTERVALS] = {
+    "sensor_to_state",
+    "state_to_siren",
+    "sensor_to_siren",
+};
+
+// Medicion en curso: de un flanco de sensor con la sirena apagada hasta
+// que la sirena se acciona
+static bool alarmLatencyArmed = false;
+static bool alarmLatencyStateSeen = false;
+static bool alarmLatencySirenOn = false;
+static alarmLatencySource_t alarmLatencySource = ALARM_LATENCY_SOURCE_GAS;
+static uint32_t alarmLatencySensorCycles = 0;
+static uint32_t alarmLatencyStateCycles = 0;
+
+//=====[Declarations (prototypes) of private functions]========================
+
+static void alarmLatencyRecordWrite( alarmLatencyInterval_t interval, uint32_t cycles );
+static void alarmLatencyRecordClear( alarmLatencyRecord_t* record );
+static uint32_t alarmLatencyPercentile( const uint32_t* sorted, int count, int percent );
+
+//=====[Implementations of public functions]===================================
+
+// Las marcas usan el contador de task_timing, por lo que taskTimingInit()
+// debe haberse llamado antes.
+void alarmLatencyInit()
+{
+    alarmLatencyArmed = false;
+    alarmLatencyStateSeen = false;
+    alarmLatencySirenOn = false;
+    alarmLatencyReset();
+}
+
+// sensorCycles es el instante del flanco segun el sensor, anterior a la
+// llamada. Solo inicia una medicion si la sirena esta apagada y no hay otra
+// en curso: un segundo detector no cambia la salida.
+void alarmLatencySensorMark( alarmLatencySource_t source, uint32_t sensorCycles )
+{
+#if ALARM_LATENCY_PROBES
+    if ( alarmLatencySirenOn || alarmLatencyArmed ) {
+        return;
+    }
+    alarmLatencySource = source;
+    alarmLatencySensorCycles = sensorCycles;
+    alarmLatencyStateSeen = false;
+    alarmLatencyArmed = true;
+#endif
+}
+
+void alarmLatencyStateMark()
+{
+#if ALARM_LATENCY_PROBES
+    if ( !alarmLatencyArmed || alarmLatencyStateSeen ) {
+        return;
+    }
+    alarmLatencyStateCycles = taskTimingStart();
+    alarmLatencyStateSeen = true;
+    alarmLatencyRecordWrite( ALARM_LATENCY_SENSOR_TO_STATE,
+                             alarmLatencyStateCycles - alarmLatencySensorCycles );
+#endif
+}
+
+// Una activacion sin flanco previo, como la del boton de prueba, no se mide
+void alarmLatencySirenMark( bool sirenOn )
+{
+#if ALARM_LATENCY_PROBES
+    uint32_t sirenCycles = taskTimingStart();
+
+    alarmLatencySirenOn = sirenOn;
+    if ( !sirenOn || !alarmLatencyArmed ) {
+        alarmLatencyArmed = false;
+        return;
+    }
+
+    if ( alarmLatencyStateSeen ) {
+        alarmLatencyRecordWrite( ALARM_LATENCY_STATE_TO_SIREN,
+                                 sirenCycles - alarmLatencyStateCycles );
+    }
+    alarmLatencyRecordWrite( ALARM_LATENCY_SENSOR_TO_SIREN,
+                             sirenCycles - alarmLatencySensorCycles );
+    alarmLatencyArmed = false;
+#endif
+}
+
+const char* alarmLatencySourceName( alarmLatencySource_t source )
+{
+    return alarmLatencySourceNames[source];
+}
+
+const char* alarmLatencyIntervalName( alarmLatencyInterval_t interval )
+{
+    return alarmLatencyIntervalNames[interval];
+}
+
+// Copia el registro en una seccion critica y ordena la copia: con
+// ALARM_LATENCY_HISTORY mediciones el p99 coincide con la peor de ellas.
+bool alarmLatencyRead( alarmLatencySource_t source, alarmLatencyInterval_t interval,
+                       alarmLatencyStats_t* stats )
+{
+    alarmLatencyRecord_t copy;
+    uint32_t value;
+    int count;
+    int i;
+    int j;
+
+    core_util_critical_section_enter();
+    copy = alarmLatencyRecords[source][interval];
+    core_util_critical_section_exit();
+
+    stats->count = copy.count;
+    if ( copy.count == 0 ) {
+        stats->minUs = 0;
+        stats->maxUs = 0;
+        stats->p50Us = 0;
+        stats->p95Us = 0;
+        stats->p99Us = 0;
+        return false;
+    }
+
+    count = copy.count < ALARM_LATENCY_HISTORY ? copy.count : ALARM_LATENCY_HISTORY;
+    for ( i = 1; i < count; i++ ) {
+        value = copy.history[i];
+        for ( j = i; j > 0 && copy.history[j - 1] > value; j-- ) {
+            copy.history[j] = copy.history[j - 1];
+        }
+        copy.history[j] = value;
+    }
+
+    stats->minUs = taskTimingCyclesToUs( copy.minCycles );
+    stats->maxUs = taskTimingCyclesToUs( copy.maxCycles );
+    stats->p50Us = taskTimingCyclesToUs( alarmLatencyPercentile( copy.history, count, 50 ) );
+    stats->p95Us = taskTimingCyclesToUs( alarmLatencyPercentile( copy.history, count, 95 ) );
+    stats->p99Us = taskTimingCyclesToUs( alarmLatencyPercentile( copy.history, count, 99 ) );
+
+    return true;
+}
+
+void alarmLatencyReset()
+{
+    int source;
+    int interval;
+
+    core_util_critical_section_enter();
+    for ( source = 0; source < ALARM_LATENCY_NUMBER_OF_SOURCES; source++ ) {
+        for ( interval = 0; interval < ALARM_LATENCY_NUMBER_OF_INTERVALS; interval++ ) {
+            alarmLatencyRecordClear( &alarmLatencyRecords[source][interval] );
+        }
+    }
+    core_util_critical_section_exit();
+}
+
+//=====[Implementations of private functions]==================================
+
+static void alarmLatencyRecordWrite( alarmLatencyInterval_t interval, uint32_t cycles )
+{
+    alarmLatencyRecord_t* record = &alarmLatencyRecords[alarmLatencySource][interval];
+
+    core_util_critical_section_enter();
+    record->history[record->count % ALARM_LATENCY_HISTORY] = cycles;
+    record->count++;
+    if ( cycles < record->minCycles ) {
+        record->minCycles = cycles;
+    }
+    if ( cycles > record->maxCycles ) {
+        record->maxCycles = cycles;
+    }
+    core_util_critical_section_exit();
+}
+
+static void alarmLatencyRecordClear( alarmLatencyRecord_t* record )
+{
+    record->count = 0;
+    record->minCycles = 0xFFFFFFFF;
+    record->maxCycles = 0;
+}
+
+// Metodo del rango mas cercano sobre los valores ya ordenados
+static uint32_t alarmLatencyPercentile( const uint32_t* sorted, int count, int percent )
+{
+    int rank = ( percent * count + 99 ) / 100;
+
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
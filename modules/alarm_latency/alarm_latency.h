@@ -0,0 +1,61 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _ALARM_LATENCY_H_
+#define _ALARM_LATENCY_H_
+
+//=====[Libraries]=============================================================
+
+#include <stdint.h>
+
+//=====[Declaration of public defines]=========================================
+
+#ifdef MBED_CONF_APP_ALARM_LATENCY_PROBES
+#define ALARM_LATENCY_PROBES       MBED_CONF_APP_ALARM_LATENCY_PROBES
+#else
+#define ALARM_LATENCY_PROBES       1
+#endif
+#define ALARM_LATENCY_HISTORY     32   // Mediciones recientes para los percentiles
+
+//=====[Declaration of public data types]======================================
+
+// Detector cuyo flanco inicio la medicion
+typedef enum {
+    ALARM_LATENCY_SOURCE_GAS,
+    ALARM_LATENCY_SOURCE_OVER_TEMP,
+    ALARM_LATENCY_NUMBER_OF_SOURCES,
+} alarmLatencySource_t;
+
+typedef enum {
+    ALARM_LATENCY_SENSOR_TO_STATE,    // Flanco del sensor hasta entrar en ALARM_STATE_ACTIVE
+    ALARM_LATENCY_STATE_TO_SIREN,     // Entrada al estado hasta accionar la sirena
+    ALARM_LATENCY_SENSOR_TO_SIREN,    // Total, flanco del sensor hasta la sirena
+    ALARM_LATENCY_NUMBER_OF_INTERVALS,
+} alarmLatencyInterval_t;
+
+typedef struct {
+    uint32_t count;             // Mediciones desde el ultimo alarmLatencyReset()
+    uint32_t minUs;
+    uint32_t maxUs;
+    uint32_t p50Us;             // Percentiles de las ultimas ALARM_LATENCY_HISTORY
+    uint32_t p95Us;
+    uint32_t p99Us;
+} alarmLatencyStats_t;
+
+//=====[Declarations (prototypes) of public functions]=========================
+
+void alarmLatencyInit();
+
+// Marcas de cada etapa, desde el hilo de alarma
+void alarmLatencySensorMark( alarmLatencySource_t source, uint32_t sensorCycles );
+void alarmLatencyStateMark();
+void alarmLatencySirenMark( bool sirenOn );
+
+const char* alarmLatencySourceName( alarmLatencySource_t source );
+const char* alarmLatencyIntervalName( alarmLatencyInterval_t interval );
+bool alarmLatencyRead( alarmLatencySource_t source, alarmLatencyInterval_t interval,
+                       alarmLatencyStats_t* stats );
+void alarmLatencyReset();
+
+//=====[#include guards - end]=================================================
+
+#endif // _ALARM_LATENCY_H_
@@ -0,0 +1,88 @@
+//=====[Libraries]=============================================================
+
+#include "mbed.h"
+#include "arm_book_lib.h"
+
+#include "alarm_output.h"
+#include "alarm_latency.h"
+
+//=====[Declaration and initialization of private global objects]==============
+
+static DigitalOut alarmLed( LED1 );
+static DigitalOut incorrectCodeLed( LED3 );
+static DigitalOut systemBlockedLed( LED2 );
+static DigitalInOut sirenPin( PE_10 );
+
+static Ticker alarmLedTicker;
+
+//=====[Declaration and initialization of private global variables]============
+
+static bool alarmOutputActive = OFF;
+static uint32_t alarmOutputBlinkingTimeMs = 0;
+
+//=====[Declarations (prototypes) of private functions]========================
+
+static void alarmLedToggle();
+
+//=====[Implementations of public functions]===================================
+
+void alarmOutputInit()
+{
+    alarmLed = OFF;
+    incorrectCodeLed = OFF;
+    systemBlockedLed = OFF;
+    sirenPin.mode( OpenDrain );
+    sirenPin.input();
+    alarmOutputActive = OFF;
+    alarmOutputBlinkingTimeMs = 0;
+}
+
+// Puede llamarse en cada tick: solo toca los pines y el ticker cuando cambia
+// el estado de la alarma o el periodo de parpadeo. El parpadeo lo hace la
+// interrupcion del ticker, sin depender de cuando corran las tareas.
+void alarmOutputUpdate( bool alarmActive, uint32_t blinkingTimeMs )
+{
+    if ( !alarmActive ) {
+        blinkingTimeMs = 0;
+    }
+    if ( alarmActive == alarmOutputActive &&
+         blinkingTimeMs == alarmOutputBlinkingTimeMs ) {
+        return;
+    }
+
+    if ( alarmActive != alarmOutputActive ) {
+        if ( alarmActive ) {
+            sirenPin.output();
+            sirenPin = LOW;
+        } else {
+            sirenPin.input();
+        }
+        alarmLatencySirenMark( alarmActive );
+        alarmOutputActive = alarmActive;
+    }
+
+    alarmLedTicker.detach();
+    if ( blinkingTimeMs > 0 ) {
+        alarmLedTicker.attach( &alarmLedToggle, std::chrono::milliseconds( blinkingTimeMs ) );
+    } else {
+        alarmLed = OFF;
+    }
+    alarmOutputBlinkingTimeMs = blinkingTimeMs;
+}
+
+void alarmOutputIncorrectCodeWrite( bool state )
+{
+    incorrectCodeLed = state;
+}
+
+void alarmOutputSystemBlockedWrite( bool state )
+{
+    systemBlockedLed = state;
+}
+
+//=====[Implementations of private functions]==================================
+
+static void alarmLedToggle()
+{
+    alarmLed = !alarmLed;
+}
@@ -0,0 +1,19 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _ALARM_OUTPUT_H_
+#define _ALARM_OUTPUT_H_
+
+//=====[Libraries]=============================================================
+
+#include <stdint.h>
+
+//=====[Declarations (prototypes) of public functions]=========================
+
+void alarmOutputInit();
+void alarmOutputUpdate( bool alarmActive, uint32_t blinkingTimeMs );
+void alarmOutputIncorrectCodeWrite( bool state );
+void alarmOutputSystemBlockedWrite( bool state );
+
+//=====[#include guards - end]=================================================
+
+#endif // _ALARM_OUTPUT_H_
@@ -0,0 +1,224 @@
+//=====[Libraries]=============================================================
+
+#include "mbed.h"
+#include "arm_book_lib.h"
+
+#include "buttons.h"
+
+//=====[Declaration of private defines]========================================
+
+#define BUTTONS_EVENT_QUEUE_MASK    ( BUTTONS_EVENT_QUEUE_SIZE - 1 )
+
+// En el STM32 la linea EXTI es el numero de pin, sea cual sea el puerto
+#define BUTTONS_EXTI_LINE( pin )    STM_PIN( pin )
+#define BUTTONS_NUMBER_OF_EXTI_LINES    16
+
+//=====[Declaration of private data types]=====================================
+
+typedef struct {
+    buttonId_t id;
+    PinName pin;
+    PinMode mode;
+} buttonsInput_t;
+
+//=====[Declaration and initialization of private global objects]==============
+
+// Se usan gpio_t y gpio_irq_t en lugar de InterruptIn, como en adc_sampler:
+// construir un InterruptIn ya toma la linea EXTI del pin, y recien en
+// buttonsInit() se sabe cuales pines pueden tener la suya.
+static gpio_t buttonsGpios[BUTTONS_NUMBER];
+static gpio_irq_t buttonsIrqs[BUTTONS_NUMBER];
+
+#if defined(TARGET_NUCLEO_F429ZI)
+// Los seis botones estan en tres puertos: PC13 (Enter), PF15 (D2), PF14 (D4),
+// PF13 (D7), PE11 (D5) y PE9 (D6). Se lee cada registro de entrada una vez.
+static PortIn buttonsPortC( PortC, 1 << 13 );
+static PortIn buttonsPortE( PortE, ( 1 << 11 ) | ( 1 << 9 ) );
+static PortIn buttonsPortF( PortF, ( 1 << 15 ) | ( 1 << 14 ) | ( 1 << 13 ) );
+#endif
+
+static Timeout buttonsDebounceTimeouts[BUTTONS_NUMBER];
+
+#if MBED_CONF_APP_LOW_POWER_MODE
+static LowPowerTicker buttonsPollTicker;
+#else
+static Ticker buttonsPollTicker;
+#endif
+
+//=====[Declaration and initialization of private global variables]============
+
+// El boton de usuario de la placa tiene su propio pull-down externo
+static const buttonsInput_t buttonsInputs[BUTTONS_NUMBER] = {
+    { BUTTON_ENTER, BUTTON1, PullNone },
+    { BUTTON_TEST,  D2,      PullDown },
+    { BUTTON_A,     D4,      PullDown },
+    { BUTTON_B,     D5,      PullDown },
+    { BUTTON_C,     D6,      PullDown },
+    { BUTTON_D,     D7,      PullDown },
+};
+
+// Botones sin linea EXTI propia, leidos por buttonsPollIsr()
+static uint32_t buttonsPolledMask = 0;
+static uint32_t buttonsPolledState = 0;
+
+// Estado de todos los botones ya filtrado del rebote, un bit por buttonId_t
+static volatile uint32_t buttonsStableState = 0;
+
+// Cola de eventos: la llenan las interrupciones de debounce y la vacia la
+// tarea que procesa los botones.
+static buttonsEvent_t buttonsEventQueue[BUTTONS_EVENT_QUEUE_SIZE];
+static volatile uint32_t buttonsEventHead = 0;
+static volatile uint32_t buttonsEventTail = 0;
+
+static buttonsEventCallback_t buttonsEventCallback = NULL;
+
+//=====[Declarations (prototypes) of private functions]========================
+
+static uint32_t buttonsPortRead();
+static void buttonsEdgeIsr( uintptr_t context, gpio_irq_event event );
+static void buttonsPollIsr();
+static void buttonsDebounceStart( int button );
+static void buttonsDebounceIsr( const buttonsInput_t* input );
+
+//=====[Implementations of public functions]===================================
+
+// Una linea EXTI sirve a un solo puerto: si dos botones comparten numero de
+// pin (PC13 y PF13 en la placa) la segunda interrupcion le quitaria la linea
+// a la primera. Por eso solo el primero de cada linea tiene interrupcion y
+// los demas se leen cada BUTTONS_POLL_PERIOD_MS. Las lineas de otros modulos
+// (PE12 del MQ-2 en adc_sampler) no se ven aca; ningun boton usa la 12.
+void buttonsInit( buttonsEventCallback_t eventCallback )
+{
+    uint32_t usedExtiLines = 0;
+    int line;
+    int i;
+
+    buttonsEventCallback = eventCallback;
+
+    for ( i = 0; i < BUTTONS_NUMBER; i++ ) {
+        gpio_init_in_ex( &buttonsGpios[i], buttonsInputs[i].pin, buttonsInputs[i].mode );
+    }
+    buttonsStableState = buttonsPortRead();
+
+    for ( i = 0; i < BUTTONS_NUMBER; i++ ) {
+        line = BUTTONS_EXTI_LINE( buttonsInputs[i].pin );
+        if ( line < 0 || line >= BUTTONS_NUMBER_OF_EXTI_LINES ||
+             ( usedExtiLines & ( 1UL << line ) ) ) {
+            buttonsPolledMask |= BUTTON_MASK( buttonsInputs[i].id );
+            continue;
+        }
+        usedExtiLines |= 1UL << line;
+
+        gpio_irq_init( &buttonsIrqs[i], buttonsInputs[i].pin, &buttonsEdgeIsr, (uintptr_t) i );
+        gpio_irq_set( &buttonsIrqs[i], IRQ_RISE, 1 );
+        gpio_irq_set( &buttonsIrqs[i], IRQ_FALL, 1 );
+        gpio_irq_enable( &buttonsIrqs[i] );
+    }
+
+    if ( buttonsPolledMask != 0 ) {
+        buttonsPolledState = buttonsStableState & buttonsPolledMask;
+        buttonsPollTicker.attach( &buttonsPollIsr,
+                                  std::chrono::milliseconds( BUTTONS_POLL_PERIOD_MS ) );
+    }
+}
+
+bool buttonsEventRead( buttonsEvent_t* event )
+{
+    uint32_t tail = buttonsEventTail;
+
+    if ( tail == buttonsEventHead ) {
+        return false;
+    }
+
+    *event = buttonsEventQueue[tail & BUTTONS_EVENT_QUEUE_MASK];
+    buttonsEventTail = tail + 1;
+    return true;
+}
+
+// Todos los botones en una sola palabra; bit n = BUTTON_MASK( n )
+uint32_t buttonsStateRead()
+{
+    return buttonsStableState;
+}
+
+//=====[Implementations of private functions]==================================
+
+// Foto de todas las entradas tomada de una vez, empaquetada con un bit por
+// buttonId_t, asi ningun boton se ve a mitad de un cambio respecto de otro.
+static uint32_t buttonsPortRead()
+{
+#if defined(TARGET_NUCLEO_F429ZI)
+    uint32_t portC = buttonsPortC.read();
+    uint32_t portE = buttonsPortE.read();
+    uint32_t portF = buttonsPortF.read();
+
+    return ( ( ( portC >> 13 ) & 1 ) << BUTTON_ENTER ) |
+           ( ( ( portF >> 15 ) & 1 ) << BUTTON_TEST  ) |
+           ( ( ( portF >> 14 ) & 1 ) << BUTTON_A     ) |
+           ( ( ( portE >> 11 ) & 1 ) << BUTTON_B     ) |
+           ( ( ( portE >>  9 ) & 1 ) << BUTTON_C     ) |
+           ( ( ( portF >> 13 ) & 1 ) << BUTTON_D     );
+#else
+    uint32_t state = 0;
+    int i;
+
+    core_util_critical_section_enter();
+    for ( i = 0; i < BUTTONS_NUMBER; i++ ) {
+        state |= ( (uint32_t) gpio_read( &buttonsGpios[i] ) ) << buttonsInputs[i].id;
+    }
+    core_util_critical_section_exit();
+
+    return state;
+#endif
+}
+
+static void buttonsEdgeIsr( uintptr_t context, gpio_irq_event event )
+{
+    buttonsDebounceStart( (int) context );
+}
+
+// Hace de detector de flancos para los botones sin interrupcion: cada cambio
+// visto en la foto de los puertos arranca el mismo debounce
+static void buttonsPollIsr()
+{
+    uint32_t state = buttonsPortRead() & buttonsPolledMask;
+    uint32_t changed = state ^ buttonsPolledState;
+    int i;
+
+    buttonsPolledState = state;
+    for ( i = 0; i < BUTTONS_NUMBER; i++ ) {
+        if ( changed & BUTTON_MASK( buttonsInputs[i].id ) ) {
+            buttonsDebounceStart( i );
+        }
+    }
+}
+
+// Cada flanco reinicia el temporizador de ese boton, asi que el pin recien
+// se lee cuando dejo de rebotar durante BUTTONS_DEBOUNCE_TIME_MS.
+static void buttonsDebounceStart( int button )
+{
+    buttonsDebounceTimeouts[button].attach( callback( buttonsDebounceIsr, &buttonsInputs[button] ),
+                                            std::chrono::milliseconds( BUTTONS_DEBOUNCE_TIME_MS ) );
+}
+
+static void buttonsDebounceIsr( const buttonsInput_t* input )
+{
+    uint32_t buttonMask = BUTTON_MASK( input->id );
+    uint32_t currentBit = buttonsPortRead() & buttonMask;
+    uint32_t head = buttonsEventHead;
+
+    if ( currentBit == ( buttonsStableState & buttonMask ) ) {
+        return;
+    }
+    buttonsStableState = ( buttonsStableState & ~buttonMask ) | currentBit;
+
+    if ( head - buttonsEventTail < BUTTONS_EVENT_QUEUE_SIZE ) {
+        buttonsEventQueue[head & BUTTONS_EVENT_QUEUE_MASK].button  = input->id;
+        buttonsEventQueue[head & BUTTONS_EVENT_QUEUE_MASK].pressed = currentBit != 0;
+        buttonsEventHead = head + 1;
+    }
+
+    if ( buttonsEventCallback != NULL ) {
+        buttonsEventCallback();
+    }
+}
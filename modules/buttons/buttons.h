@@ -0,0 +1,50 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _BUTTONS_H_
+#define _BUTTONS_H_
+
+//=====[Libraries]=============================================================
+
+#include <stdint.h>
+
+//=====[Declaration of public defines]=========================================
+
+#define BUTTONS_DEBOUNCE_TIME_MS      30
+#define BUTTONS_POLL_PERIOD_MS         5   // Botones que comparten linea EXTI
+#define BUTTONS_EVENT_QUEUE_SIZE      16   // Potencia de 2
+
+#define BUTTON_MASK( button )    ( 1UL << ( button ) )
+
+// Teclas A a D en bits consecutivos: ( estado >> BUTTON_A ) & 0xF da el
+// codigo ingresado con A en el bit 0
+#define BUTTONS_CODE_MASK        ( BUTTON_MASK( BUTTON_A ) | BUTTON_MASK( BUTTON_B ) | \
+                                   BUTTON_MASK( BUTTON_C ) | BUTTON_MASK( BUTTON_D ) )
+
+//=====[Declaration of public data types]======================================
+
+typedef enum {
+    BUTTON_ENTER,   // BUTTON1
+    BUTTON_TEST,    // D2
+    BUTTON_A,       // D4
+    BUTTON_B,       // D5
+    BUTTON_C,       // D6
+    BUTTON_D,       // D7
+    BUTTONS_NUMBER,
+} buttonId_t;
+
+typedef struct {
+    buttonId_t button;
+    bool pressed;    // true al presionar, false al soltar
+} buttonsEvent_t;
+
+typedef void (*buttonsEventCallback_t)();
+
+//=====[Declarations (prototypes) of public functions]=========================
+
+void buttonsInit( buttonsEventCallback_t eventCallback );
+bool buttonsEventRead( buttonsEvent_t* event );
+uint32_t buttonsStateRead();
+
+//=====[#include guards - end]=================================================
+
+#endif // _BUTTONS_H_
@@ -0,0 +1,283 @@
+//=====[Libraries]=============================================================
+
+#include "mbed.h"
+#include "arm_book_lib.h"
+#include "FlashIAPBlockDevice.h"
+#include "TDBStore.h"
+
+#include "config_store.h"
+#include "alarm_config.h"
+#include "flash_log.h"
+#include "scheduler.h"
+
+#include <stddef.h>
+#include <string.h>
+
+//=====[Declaration of private defines]========================================
+
+// Zona justo debajo del anillo de flash_log, tambien en el banco 2
+#define CONFIG_STORE_ADDRESS    ( MBED_ROM_START + MBED_ROM_SIZE - FLASH_LOG_SIZE - \
+                                  CONFIG_STORE_SIZE )
+
+#define CONFIG_STORE_FNV_OFFSET    2166136261UL
+#define CONFIG_STORE_FNV_PRIME       16777619UL
+
+#define CONFIG_STORE_LM35_MAX_CENTI_C    15000   // Rango de medicion del LM35
+
+//=====[Declaration of private data types]=====================================
+
+// Cada grupo es una clave del KVStore: un cambio graba solo los grupos que
+// toco y varios cambios seguidos se graban juntos.
+typedef enum {
+    CONFIG_STORE_GROUP_CODE,
+    CONFIG_STORE_GROUP_THRESHOLDS,
+    CONFIG_STORE_GROUP_BLINKING,
+    CONFIG_STORE_GROUP_FILTER,
+    CONFIG_STORE_NUMBER_OF_GROUPS,
+} configStoreGroupId_t;
+
+typedef struct {
+    const char* key;
+    size_t offset;
+    size_t size;
+} configStoreGroup_t;
+
+//=====[Declaration and initialization of private global objects]==============
+
+static FlashIAPBlockDevice configStoreBlockDevice( CONFIG_STORE_ADDRESS, CONFIG_STORE_SIZE );
+static TDBStore configStoreKv( &configStoreBlockDevice );
+
+//=====[Declaration and initialization of private global variables]============
+
+static const configStoreGroup_t configStoreGroups[CONFIG_STORE_NUMBER_OF_GROUPS] = {
+    { "code",       offsetof( configStoreSettings_t, codeHash ),
+                    sizeof( uint32_t ) },
+    { "thresholds", offsetof( configStoreSettings_t, overTempLevelCentiC ),
+                    offsetof( configStoreSettings_t, blinkingTimeMs ) -
+                    offsetof( configStoreSettings_t, overTempLevelCentiC ) },
+    { "blinking",   offsetof( configStoreSettings_t, blinkingTimeMs ),
+                    sizeof( ( (configStoreSettings_t*) 0 )->blinkingTimeMs ) },
+    { "filter",     offsetof( configStoreSettings_t, numberOfAvgSamples ),
+                    sizeof( int32_t ) },
+};
+
+// El hash evita que el codigo quede legible en un volcado de la flash. Con
+// solo 2^numberOfKeys codigos posibles no protege de una busqueda exhaustiva.
+static const char configStoreCodeSalt[] = "gas-alarm-code";
+
+static configStoreSettings_t configStoreSettings;
+static uint32_t configStoreDirty = 0;           // Un bit por configStoreGroupId_t
+static uint32_t configStoreChangedMs = 0;
+static bool configStoreReady = false;
+
+//=====[Declarations (prototypes) of private functions]========================
+
+static void configStoreDefaultsLoad( configStoreSettings_t* settings );
+static void configStoreGroupLoad( configStoreGroupId_t group );
+static bool configStoreGroupValid( const configStoreSettings_t* settings,
+                                   configStoreGroupId_t group );
+static uint8_t* configStoreGroupBytes( configStoreSettings_t* settings,
+                                       configStoreGroupId_t group );
+static uint32_t configStoreCodeHash( uint32_t code );
+
+//=====[Implementations of public functions]===================================
+
+// Lee la flash una sola vez. Un grupo que falta o no pasa la validacion
+// queda con el valor del perfil. Si el KVStore no arranca, la configuracion
+// funciona igual pero solo en RAM y retorna false.
+bool configStoreInit()
+{
+    int group;
+
+    configStoreDefaultsLoad( &configStoreSettings );
+    configStoreDirty = 0;
+    configStoreReady = false;
+
+    if ( configStoreKv.init() != MBED_SUCCESS ) {
+        return false;
+    }
+    configStoreReady = true;
+
+    for ( group = 0; group < CONFIG_STORE_NUMBER_OF_GROUPS; group++ ) {
+        configStoreGroupLoad( (configStoreGroupId_t) group );
+    }
+
+    return true;
+}
+
+const configStoreSettings_t* configStoreRead()
+{
+    return &configStoreSettings;
+}
+
+bool configStoreCodeMatches( uint32_t code )
+{
+    return configStoreCodeHash( code ) == configStoreSettings.codeHash;
+}
+
+// Se descartan los grupos con valores fuera de rango; el resto se copia
+// si cambio.
+void configStoreWrite( const configStoreSettings_t* settings )
+{
+    configStoreSettings_t candidate = *settings;
+    uint8_t* source;
+    uint8_t* destination;
+    int group;
+
+    for ( group = 0; group < CONFIG_STORE_NUMBER_OF_GROUPS; group++ ) {
+        if ( !configStoreGroupValid( &candidate, (configStoreGroupId_t) group ) ) {
+            continue;
+        }
+        source = configStoreGroupBytes( &candidate, (configStoreGroupId_t) group );
+        destination = configStoreGroupBytes( &configStoreSettings, (configStoreGroupId_t) group );
+
+        core_util_critical_section_enter();
+        if ( memcmp( destination, source, configStoreGroups[group].size ) != 0 ) {
+            memcpy( destination, source, configStoreGroups[group].size );
+            configStoreDirty |= 1UL << group;
+            configStoreChangedMs = schedulerTimeMs();
+        }
+        core_util_critical_section_exit();
+    }
+}
+
+void configStoreCodeWrite( uint32_t code )
+{
+    configStoreSettings_t settings = configStoreSettings;
+
+    settings.codeHash = configStoreCodeHash( code );
+    configStoreWrite( &settings );
+}
+
+// Graba recien CONFIG_STORE_WRITE_DELAY_MS despues del ultimo cambio, una
+// vez por grupo modificado. Un grupo que no se pudo grabar se reintenta
+// tras otra espera.
+void configStoreUpdate()
+{
+    configStoreSettings_t copy;
+    uint32_t dirty;
+    uint32_t failed = 0;
+    int group;
+
+    if ( !configStoreReady || configStoreDirty == 0 ||
+         schedulerTimeMs() - configStoreChangedMs < CONFIG_STORE_WRITE_DELAY_MS ) {
+        return;
+    }
+
+    core_util_critical_section_enter();
+    dirty = configStoreDirty;
+    configStoreDirty = 0;
+    copy = configStoreSettings;
+    core_util_critical_section_exit();
+
+    // set() puede compactar el TDBStore y borrar un sector entero
+    flashLogFlashLock();
+    for ( group = 0; group < CONFIG_STORE_NUMBER_OF_GROUPS; group++ ) {
+        if ( ( dirty & ( 1UL << group ) ) &&
+             configStoreKv.set( configStoreGroups[group].key,
+                                configStoreGroupBytes( &copy, (configStoreGroupId_t) group ),
+                                configStoreGroups[group].size, 0 ) != MBED_SUCCESS ) {
+            failed |= 1UL << group;
+        }
+    }
+    flashLogFlashUnlock();
+
+    if ( failed != 0 ) {
+        core_util_critical_section_enter();
+        configStoreDirty |= failed;
+        configStoreChangedMs = schedulerTimeMs();
+        core_util_critical_section_exit();
+    }
+}
+
+// Hay cambios en RAM que todavia no estan en la flash
+bool configStorePending()
+{
+    return configStoreDirty != 0;
+}
+
+//=====[Implementations of private functions]==================================
+
+static void configStoreDefaultsLoad( configStoreSettings_t* settings )
+{
+    int i;
+
+    settings->codeHash = configStoreCodeHash( CONFIG_STORE_DEFAULT_CODE );
+    settings->overTempLevelCentiC = alarmConfig::overTempLevel * 100;
+    settings->overTempHysteresisCentiC = alarmConfig::overTempHysteresis;
+    settings->overTempRiseRateCentiCPerS = alarmConfig::overTempRiseRate;
+    for ( i = 0; i < 4; i++ ) {
+        settings->blinkingTimeMs[i] = alarmConfig::blinkingTimeMs[i];
+    }
+    settings->numberOfAvgSamples = alarmConfig::numberOfAvgSamples;
+}
+
+static void configStoreGroupLoad( configStoreGroupId_t group )
+{
+    configStoreSettings_t candidate = configStoreSettings;
+    size_t actualSize = 0;
+
+    if ( configStoreKv.get( configStoreGroups[group].key,
+                            configStoreGroupBytes( &candidate, group ),
+                            configStoreGroups[group].size, &actualSize ) != MBED_SUCCESS ||
+         actualSize != configStoreGroups[group].size ||
+         !configStoreGroupValid( &candidate, group ) ) {
+        return;
+    }
+
+    memcpy( configStoreGroupBytes( &configStoreSettings, group ),
+            configStoreGroupBytes( &candidate, group ), configStoreGroups[group].size );
+}
+
+static bool configStoreGroupValid( const configStoreSettings_t* settings,
+                                   configStoreGroupId_t group )
+{
+    int i;
+
+    switch ( group ) {
+    case CONFIG_STORE_GROUP_THRESHOLDS:
+        return settings->overTempLevelCentiC > 0 &&
+               settings->overTempLevelCentiC <= CONFIG_STORE_LM35_MAX_CENTI_C &&
+               settings->overTempHysteresisCentiC >= 0 &&
+               settings->overTempHysteresisCentiC <= settings->overTempLevelCentiC &&
+               settings->overTempRiseRateCentiCPerS >= 0;
+    case CONFIG_STORE_GROUP_BLINKING:
+        if ( settings->blinkingTimeMs[0] != 0 ) {
+            return false;
+        }
+        for ( i = 1; i < 4; i++ ) {
+            if ( settings->blinkingTimeMs[i] == 0 ) {
+                return false;
+            }
+        }
+        return true;
+    case CONFIG_STORE_GROUP_FILTER:
+        return settings->numberOfAvgSamples >= 1 &&
+               settings->numberOfAvgSamples <= alarmConfig::numberOfAvgSamples;
+    case CONFIG_STORE_GROUP_CODE:
+    default:
+        return true;
+    }
+}
+
+static uint8_t* configStoreGroupBytes( configStoreSettings_t* settings,
+                                       configStoreGroupId_t group )
+{
+    return (uint8_t*) settings + configStoreGroups[group].offset;
+}
+
+// FNV-1a de 32 bits sobre la sal y el codigo
+static uint32_t configStoreCodeHash( uint32_t code )
+{
+    uint32_t hash = CONFIG_STORE_FNV_OFFSET;
+    size_t i;
+
+    for ( i = 0; i < sizeof( configStoreCodeSalt ) - 1; i++ ) {
+        hash = ( hash ^ (uint8_t) configStoreCodeSalt[i] ) * CONFIG_STORE_FNV_PRIME;
+    }
+    for ( i = 0; i < sizeof( code ); i++ ) {
+        hash = ( hash ^ (uint8_t) ( code >> ( 8 * i ) ) ) * CONFIG_STORE_FNV_PRIME;
+    }
+
+    return hash;
+}
@@ -0,0 +1,51 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _CONFIG_STORE_H_
+#define _CONFIG_STORE_H_
+
+//=====[Libraries]=============================================================
+
+#include <stdint.h>
+
+//=====[Declaration of public defines]=========================================
+
+#ifdef MBED_CONF_APP_CONFIG_STORE_SIZE
+#define CONFIG_STORE_SIZE                MBED_CONF_APP_CONFIG_STORE_SIZE
+#else
+#define CONFIG_STORE_SIZE                ( 256 * 1024 )  // Dos sectores de 128 KB, uno por area
+#endif
+#define CONFIG_STORE_WRITE_DELAY_MS       5000   // Espera tras el ultimo cambio antes de grabar
+#define CONFIG_STORE_DEFAULT_CODE          0x3   // Bit 0 'A' ... bit 3 'D': A y B presionados
+
+//=====[Declaration of public data types]======================================
+
+// Copia en RAM de la configuracion persistente. Arranca con los valores del
+// perfil de alarm_config.h y se pisa con lo que haya en la flash.
+typedef struct {
+    uint32_t codeHash;                  // Ver configStoreCodeWrite()
+    int32_t overTempLevelCentiC;
+    int32_t overTempHysteresisCentiC;
+    int32_t overTempRiseRateCentiCPerS;
+    uint32_t blinkingTimeMs[4];         // Indexado por ALARM_DETECTOR_GAS | ALARM_DETECTOR_OVER_TEMP
+    int32_t numberOfAvgSamples;         // Hasta alarmConfig::numberOfAvgSamples
+} configStoreSettings_t;
+
+//=====[Declarations (prototypes) of public functions]=========================
+
+bool configStoreInit();
+
+// Lecturas sin costo desde cualquier hilo: cada campo es una palabra
+const configStoreSettings_t* configStoreRead();
+bool configStoreCodeMatches( uint32_t code );
+
+// Solo cambian la copia en RAM; configStoreUpdate() graba despues
+void configStoreWrite( const configStoreSettings_t* settings );
+void configStoreCodeWrite( uint32_t code );
+
+// Desde el hilo de telemetria
+void configStoreUpdate();
+bool configStorePending();
+
+//=====[#include guards - end]=================================================
+
+#endif // _CONFIG_STORE_H_
@@ -0,0 +1,340 @@
+//=====[Libraries]=============================================================
+
+#include "mbed.h"
+#include "arm_book_lib.h"
+
+#include "console_command.h"
+#include "pc_serial_com.h"
+
+#include <string.h>
+
+//=====[Declaration of private defines]========================================
+
+// Tecla que la tabla de teclas asocia a la ayuda; la pide la respuesta a
+// una tecla desconocida
+#define CONSOLE_COMMAND_HELP_KEY    "h"
+
+//=====[Declaration of private data types]=====================================
+
+typedef enum {
+    CONSOLE_COMMAND_HELP_KEYS_TITLE,
+    CONSOLE_COMMAND_HELP_KEYS,
+    CONSOLE_COMMAND_HELP_LINES_TITLE,
+    CONSOLE_COMMAND_HELP_LINES,
+    CONSOLE_COMMAND_HELP_END,
+    CONSOLE_COMMAND_HELP_DONE,
+} consoleCommandHelpSection_t;
+
+//=====[Declaration and initialization of private global variables]============
+
+static const consoleKeyCommand_t* consoleKeyCommands = NULL;
+static int consoleNumberOfKeyCommands = 0;
+static const consoleLineCommand_t* consoleLineCommands = NULL;
+static int consoleNumberOfLineCommands = 0;
+
+// Linea en curso, desde CONSOLE_COMMAND_LINE_START hasta el Enter
+static char consoleCommandLine[CONSOLE_COMMAND_LINE_MAX_LENGTH + 1];
+static int consoleCommandLineLength = 0;
+static bool consoleCommandLineActive = false;
+static bool consoleCommandLineOverflow = false;
+
+static consoleCommandHelpSection_t consoleCommandHelpSection = CONSOLE_COMMAND_HELP_DONE;
+static int consoleCommandHelpIndex = 0;
+
+//=====[Declarations (prototypes) of private functions]========================
+
+static void consoleCommandKeyRun( char receivedChar );
+static void consoleCommandLineRun();
+static bool consoleCommandSegmentRun( char* segment );
+static int consoleCommandTokenize( char* segment, const char** argv );
+static int consoleCommandAppend( char* line, int length, const char* str );
+static int consoleCommandKeyHelpFormat( char* line, const consoleKeyCommand_t* command );
+static int consoleCommandLineHelpFormat( char* line, const consoleLineCommand_t* command );
+
+//=====[Implementations of public functions]===================================
+
+// Las tablas deben seguir existiendo mientras corre la consola
+void consoleCommandInit( const consoleKeyCommand_t* keyCommands, int numberOfKeyCommands,
+                         const consoleLineCommand_t* lineCommands, int numberOfLineCommands )
+{
+    consoleKeyCommands = keyCommands;
+    consoleNumberOfKeyCommands = numberOfKeyCommands;
+    consoleLineCommands = lineCommands;
+    consoleNumberOfLineCommands = numberOfLineCommands;
+    consoleCommandLineActive = false;
+    consoleCommandHelpSection = CONSOLE_COMMAND_HELP_DONE;
+}
+
+// Fuera de una linea cada caracter es un comando de una tecla; el Enter y
+// los espacios sueltos se ignoran. Dentro de una linea se acumula hasta el
+// Enter, con borrado para quien la escribe a mano.
+void consoleCommandCharWrite( char receivedChar )
+{
+    if ( !consoleCommandLineActive ) {
+        consoleCommandKeyRun( receivedChar );
+        return;
+    }
+
+    if ( receivedChar == '\r' || receivedChar == '\n' ) {
+        consoleCommandLineActive = false;
+        consoleCommandLineRun();
+    } else if ( receivedChar == '\b' || receivedChar == 0x7F ) {
+        if ( consoleCommandLineLength > 0 ) {
+            consoleCommandLineLength--;
+        }
+    } else if ( consoleCommandLineLength < CONSOLE_COMMAND_LINE_MAX_LENGTH ) {
+        if ( receivedChar >= 'A' && receivedChar <= 'Z' ) {
+            receivedChar = receivedChar - 'A' + 'a';
+        }
+        consoleCommandLine[consoleCommandLineLength++] = receivedChar;
+    } else {
+        consoleCommandLineOverflow = true;
+    }
+}
+
+void consoleCommandHelpStart()
+{
+    consoleCommandHelpSection = CONSOLE_COMMAND_HELP_KEYS_TITLE;
+    consoleCommandHelpIndex = 0;
+}
+
+// Cada linea ocupa hasta CONSOLE_COMMAND_HELP_LINE_MAX_LENGTH; quien llama
+// espera a que haya ese lugar en el buffer de TX, como con el log de flash.
+bool consoleCommandHelpLineWrite()
+{
+    char line[CONSOLE_COMMAND_HELP_LINE_MAX_LENGTH + 1];
+    int length = 0;
+
+    switch ( consoleCommandHelpSection ) {
+    case CONSOLE_COMMAND_HELP_KEYS_TITLE:
+        length = consoleCommandAppend( line, 0, "Available commands:\r\n" );
+        consoleCommandHelpSection = CONSOLE_COMMAND_HELP_KEYS;
+        break;
+
+    case CONSOLE_COMMAND_HELP_KEYS:
+        if ( consoleCommandHelpIndex >= consoleNumberOfKeyCommands ) {
+            consoleCommandHelpSection = CONSOLE_COMMAND_HELP_LINES_TITLE;
+            consoleCommandHelpIndex = 0;
+            return consoleCommandHelpLineWrite();
+        }
+        length = consoleCommandKeyHelpFormat( line,
+                                              &consoleKeyCommands[consoleCommandHelpIndex++] );
+        break;
+
+    case CONSOLE_COMMAND_HELP_LINES_TITLE:
+        length = consoleCommandAppend( line, 0, "Type ':' and a line ending in Enter, "
+                                       "with ';' between commands, for one reply:\r\n" );
+        consoleCommandHelpSection = CONSOLE_COMMAND_HELP_LINES;
+        break;
+
+    case CONSOLE_COMMAND_HELP_LINES:
+        if ( consoleCommandHelpIndex >= consoleNumberOfLineCommands ) {
+            consoleCommandHelpSection = CONSOLE_COMMAND_HELP_END;
+            return consoleCommandHelpLineWrite();
+        }
+        length = consoleCommandLineHelpFormat( line,
+                                               &consoleLineCommands[consoleCommandHelpIndex++] );
+        break;
+
+    case CONSOLE_COMMAND_HELP_END:
+        length = consoleCommandAppend( line, 0, "\r\n" );
+        consoleCommandHelpSection = CONSOLE_COMMAND_HELP_DONE;
+        break;
+
+    case CONSOLE_COMMAND_HELP_DONE:
+    default:
+        return false;
+    }
+
+    pcSerialComWrite( line, length );
+    return true;
+}
+
+// Numero sin signo en base 10 o 16, sin prefijo; falla si esta vacio, tiene
+// otros caracteres o no entra en 32 bits
+bool consoleCommandArgUnsigned( const char* arg, uint32_t base, uint32_t* value )
+{
+    uint32_t result = 0;
+    uint32_t digit;
+
+    if ( *arg == '\0' ) {
+        return false;
+    }
+
+    for ( ; *arg != '\0'; arg++ ) {
+        if ( *arg >= '0' && *arg <= '9' ) {
+            digit = *arg - '0';
+        } else if ( *arg >= 'a' && *arg <= 'f' ) {
+            digit = *arg - 'a' + 10;
+        } else {
+            return false;
+        }
+        if ( digit >= base || result > ( 0xFFFFFFFFUL - digit ) / base ) {
+            return false;
+        }
+        result = result * base + digit;
+    }
+
+    *value = result;
+    return true;
+}
+
+void consoleCommandErrorWrite( const char* name, const char* error )
+{
+    pcSerialComMessageString( "error " );
+    pcSerialComMessageString( name );
+    pcSerialComMessageString( ": " );
+    pcSerialComMessageString( error );
+    pcSerialComMessageString( "\r\n" );
+}
+
+//=====[Implementations of private functions]==================================
+
+static void consoleCommandKeyRun( char receivedChar )
+{
+    int i;
+
+    if ( receivedChar == CONSOLE_COMMAND_LINE_START ) {
+        consoleCommandLineActive = true;
+        consoleCommandLineLength = 0;
+        consoleCommandLineOverflow = false;
+        return;
+    }
+    if ( receivedChar == '\r' || receivedChar == '\n' || receivedChar == ' ' ) {
+        return;
+    }
+
+    for ( i = 0; i < consoleNumberOfKeyCommands; i++ ) {
+        if ( receivedChar != '\0' && strchr( consoleKeyCommands[i].keys, receivedChar ) != NULL ) {
+            consoleKeyCommands[i].handler();
+            return;
+        }
+    }
+
+    pcSerialComStringWrite( "Unknown command, press '" CONSOLE_COMMAND_HELP_KEY "' for help\r\n" );
+}
+
+// Todas las respuestas de la linea van en un solo mensaje, cerrado con OK o
+// ERROR segun hayan fallado o no sus comandos
+static void consoleCommandLineRun()
+{
+    char* segment = consoleCommandLine;
+    char* separator;
+    bool succeeded = true;
+
+    consoleCommandLine[consoleCommandLineLength] = '\0';
+
+    pcSerialComMessageBegin();
+    if ( consoleCommandLineOverflow ) {
+        consoleCommandErrorWrite( "line", "too long" );
+        succeeded = false;
+    } else {
+        do {
+            separator = strchr( segment, CONSOLE_COMMAND_LINE_SEPARATOR );
+            if ( separator != NULL ) {
+                *separator = '\0';
+            }
+            if ( !consoleCommandSegmentRun( segment ) ) {
+                succeeded = false;
+            }
+            segment = separator + 1;
+        } while ( separator != NULL );
+    }
+    pcSerialComMessageString( succeeded ? "OK\r\n" : "ERROR\r\n" );
+    pcSerialComMessageEnd();
+}
+
+// Un segmento vacio, como el que deja un ';' al final, no es un error
+static bool consoleCommandSegmentRun( char* segment )
+{
+    const char* argv[CONSOLE_COMMAND_MAX_ARGS];
+    int argc = consoleCommandTokenize( segment, argv );
+    int i;
+
+    if ( argc == 0 ) {
+        return true;
+    }
+    if ( argc > CONSOLE_COMMAND_MAX_ARGS ) {
+        consoleCommandErrorWrite( argv[0], "too many arguments" );
+        return false;
+    }
+
+    for ( i = 0; i < consoleNumberOfLineCommands; i++ ) {
+        if ( strcmp( argv[0], consoleLineCommands[i].name ) == 0 ) {
+            return consoleLineCommands[i].handler( argc, argv );
+        }
+    }
+
+    consoleCommandErrorWrite( argv[0], "unknown command" );
+    return false;
+}
+
+// Separa los tokens en el mismo buffer. Retorna la cantidad encontrada,
+// aunque solo guarda los primeros CONSOLE_COMMAND_MAX_ARGS.
+static int consoleCommandTokenize( char* segment, const char** argv )
+{
+    int argc = 0;
+
+    while ( *segment != '\0' ) {
+        while ( *segment == ' ' || *segment == '\t' ) {
+            *segment++ = '\0';
+        }
+        if ( *segment == '\0' ) {
+            break;
+        }
+        if ( argc < CONSOLE_COMMAND_MAX_ARGS ) {
+            argv[argc] = segment;
+        }
+        argc++;
+        while ( *segment != '\0' && *segment != ' ' && *segment != '\t' ) {
+            segment++;
+        }
+    }
+
+    return argc;
+}
+
+// Agrega str recortando en CONSOLE_COMMAND_HELP_LINE_MAX_LENGTH
+static int consoleCommandAppend( char* line, int length, const char* str )
+{
+    while ( *str != '\0' && length < CONSOLE_COMMAND_HELP_LINE_MAX_LENGTH ) {
+        line[length++] = *str++;
+    }
+    line[length] = '\0';
+    return length;
+}
+
+// "Press 'p' or 'P' to get potentiometer reading"
+static int consoleCommandKeyHelpFormat( char* line, const consoleKeyCommand_t* command )
+{
+    char key[4] = { '\'', '\0', '\'', '\0' };
+    int numberOfKeys = strlen( command->keys );
+    int length = consoleCommandAppend( line, 0, "Press " );
+    int i;
+
+    for ( i = 0; i < numberOfKeys; i++ ) {
+        if ( i > 0 ) {
+            length = consoleCommandAppend( line, length, i == numberOfKeys - 1 ? " or " : ", " );
+        }
+        key[1] = command->keys[i];
+        length = consoleCommandAppend( line, length, key );
+    }
+    length = consoleCommandAppend( line, length, " to " );
+    length = consoleCommandAppend( line, length, command->help );
+    return consoleCommandAppend( line, length, "\r\n" );
+}
+
+// "  set threshold <celsius>: set the maximum temperature"
+static int consoleCommandLineHelpFormat( char* line, const consoleLineCommand_t* command )
+{
+    int length = consoleCommandAppend( line, 0, "  " );
+
+    length = consoleCommandAppend( line, length, command->name );
+    if ( command->usage[0] != '\0' ) {
+        length = consoleCommandAppend( line, length, " " );
+        length = consoleCommandAppend( line, length, command->usage );
+    }
+    length = consoleCommandAppend( line, length, ": " );
+    length = consoleCommandAppend( line, length, command->help );
+    return consoleCommandAppend( line, length, "\r\n" );
+}
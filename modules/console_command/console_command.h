@@ -0,0 +1,57 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _CONSOLE_COMMAND_H_
+#define _CONSOLE_COMMAND_H_
+
+//=====[Libraries]=============================================================
+
+#include <stdint.h>
+
+//=====[Declaration of public defines]=========================================
+
+#define CONSOLE_COMMAND_LINE_START              ':'   // Primer caracter de una linea de comandos
+#define CONSOLE_COMMAND_LINE_SEPARATOR          ';'   // Separa comandos de una misma linea
+#define CONSOLE_COMMAND_LINE_MAX_LENGTH          96
+#define CONSOLE_COMMAND_MAX_ARGS                 12   // Incluye el nombre del comando
+#define CONSOLE_COMMAND_HELP_LINE_MAX_LENGTH    120
+
+//=====[Declaration of public data types]======================================
+
+// Comando de una tecla, atendido apenas llega el caracter
+typedef struct {
+    const char* keys;           // Teclas que lo ejecutan, por ejemplo "pP"
+    const char* help;           // Completa "Press 'p' or 'P' to ..."
+    void (*handler)();
+} consoleKeyCommand_t;
+
+// Comando de una linea con argumentos. argv[0] es el nombre y todos los
+// tokens llegan en minusculas. El handler agrega su respuesta, terminada en
+// "\r\n", al mensaje ya abierto con pcSerialComMessageBegin() y retorna
+// false si el comando fallo.
+typedef struct {
+    const char* name;
+    const char* usage;          // Argumentos para la ayuda, por ejemplo "<celsius>"
+    const char* help;
+    bool (*handler)( int argc, const char* const* argv );
+} consoleLineCommand_t;
+
+//=====[Declarations (prototypes) of public functions]=========================
+
+void consoleCommandInit( const consoleKeyCommand_t* keyCommands, int numberOfKeyCommands,
+                         const consoleLineCommand_t* lineCommands, int numberOfLineCommands );
+
+// Desde el hilo de consola, por cada caracter recibido
+void consoleCommandCharWrite( char receivedChar );
+
+// Ayuda generada con las tablas, una linea por llamada a
+// consoleCommandHelpLineWrite() hasta que retorna false
+void consoleCommandHelpStart();
+bool consoleCommandHelpLineWrite();
+
+// Para los handlers de linea
+bool consoleCommandArgUnsigned( const char* arg, uint32_t base, uint32_t* value );
+void consoleCommandErrorWrite( const char* name, const char* error );
+
+//=====[#include guards - end]=================================================
+
+#endif // _CONSOLE_COMMAND_H_
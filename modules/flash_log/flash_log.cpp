@@ -0,0 +1,528 @@
+//=====[Libraries]=============================================================
+
+#include "mbed.h"
+#include "arm_book_lib.h"
+
+#include "flash_log.h"
+#include "scheduler.h"
+#include "spsc_queue.h"
+#include "pc_serial_com.h"
+
+//=====[Declaration of private defines]========================================
+
+// Formato de cada pagina, en little endian:
+//
+//   encabezado (14 bytes): magic u16, secuencia u32, tiempo base u32 (ms
+//                          desde el arranque), temperatura base i16
+//                          (centesimas de grado), reservado u16
+//   registros:             tag u8, delta de tiempo en varint y, si es una
+//                          muestra, delta de temperatura en varint zigzag
+//   relleno:               0xFF hasta el final de la pagina
+//
+// Cada pagina se decodifica sola, asi que el anillo se puede leer aunque
+// la pagina mas vieja ya se haya borrado.
+#define FLASH_LOG_MAGIC                 0x4C47   // "GL"
+#define FLASH_LOG_HEADER_SIZE               14
+#define FLASH_LOG_RECORD_MAX_SIZE            9   // tag + varint de 32 bits + varint de 17 bits
+#define FLASH_LOG_NUMBER_OF_PAGES       ( FLASH_LOG_SIZE / FLASH_LOG_PAGE_SIZE )
+#define FLASH_LOG_ERASED_BYTE             0xFF
+
+#define FLASH_LOG_TAG_TYPE_MASK           0x03
+#define FLASH_LOG_TAG_SAMPLE              0x01
+#define FLASH_LOG_TAG_EVENT               0x02
+#define FLASH_LOG_TAG_GAS                 0x04   // Muestras: MQ-2 detectando gas
+#define FLASH_LOG_TAG_EVENT_SHIFT            3   // Eventos: flashLogEvent_t en los bits 3 a 7
+
+//=====[Declaration of private data types]=====================================
+
+typedef struct {
+    uint32_t timeMs;
+    int16_t tempCentiC;
+    uint8_t type;               // FLASH_LOG_TAG_SAMPLE o FLASH_LOG_TAG_EVENT
+    uint8_t value;              // Gas detectado o flashLogEvent_t
+} flashLogRecord_t;
+
+typedef struct {
+    uint32_t sequence;
+    uint32_t timeMs;
+    int16_t tempCentiC;
+} flashLogPageHeader_t;
+
+//=====[Declaration and initialization of private global objects]==============
+
+static FlashIAP flashLogFlash;
+
+// El escritor y el volcado por consola corren en hilos distintos
+static Mutex flashLogMutex;
+
+//=====[Declaration and initialization of private global variables]============
+
+static const char* const flashLogEventNames[FLASH_LOG_NUMBER_OF_EVENTS] = {
+    "BOOT", "ALARM_ON", "ALARM_OFF", "CODE_FAIL", "LOCKOUT", "WATCHDOG_RESET",
+};
+
+static bool flashLogReady = false;
+static uint32_t flashLogStartAddress = 0;
+
+static spscQueue_t<flashLogRecord_t, FLASH_LOG_QUEUE_SIZE> flashLogQueue;
+static uint32_t flashLogDroppedCount = 0;
+
+// Pagina en armado en RAM
+static uint8_t flashLogPage[FLASH_LOG_PAGE_SIZE];
+static int flashLogPageUsed = 0;
+static uint32_t flashLogPageOpenedMs = 0;
+static uint32_t flashLogPageLastTimeMs = 0;
+static int16_t flashLogPageLastTempCentiC = 0;
+
+static uint32_t flashLogWritePage = 0;      // Proxima pagina a grabar
+static uint32_t flashLogNextSequence = 0;
+
+// Volcado por consola
+static uint8_t flashLogDumpPage[FLASH_LOG_PAGE_SIZE];
+static uint32_t flashLogDumpPagesLeft = 0;
+static uint32_t flashLogDumpPageIndex = 0;
+static int flashLogDumpOffset = FLASH_LOG_PAGE_SIZE;
+static uint32_t flashLogDumpTimeMs = 0;
+static int flashLogDumpTempCentiC = 0;
+static uint32_t flashLogDumpRecords = 0;
+static bool flashLogDumpBegun = false;
+static bool flashLogDumpActive = false;
+
+//=====[Declarations (prototypes) of private functions]========================
+
+static void flashLogRecordPush( const flashLogRecord_t* record );
+static void flashLogRecordEncode( const flashLogRecord_t* record );
+static void flashLogPageOpen( const flashLogRecord_t* record );
+static void flashLogPageFlush();
+static uint32_t flashLogPageAddress( uint32_t page );
+static bool flashLogPageHeaderRead( const uint8_t* page, flashLogPageHeader_t* header );
+static bool flashLogPageIsErased( uint32_t page );
+static bool flashLogDumpPageLoad( bool* busy );
+static bool flashLogDumpRecordDecode();
+
+static int flashLogVarintWrite( uint8_t* buffer, uint32_t value );
+static int flashLogVarintRead( const uint8_t* buffer, int length, uint32_t* value );
+static uint32_t flashLogLittleEndianRead( const uint8_t* buffer, int length );
+static void flashLogLittleEndianWrite( uint8_t* buffer, uint32_t value, int length );
+
+//=====[Implementations of public functions]===================================
+
+// Ubica el anillo al final de la flash y busca la pagina con la secuencia
+// mas alta para seguir despues de ella. Retorna false y deja el log
+// deshabilitado si la zona no coincide con limites de sector.
+bool flashLogInit()
+{
+    flashLogPageHeader_t header;
+    uint8_t headerBytes[FLASH_LOG_HEADER_SIZE];
+    uint32_t flashEnd;
+    uint32_t page;
+    bool found = false;
+
+    spscQueueInit( &flashLogQueue );
+    flashLogReady = false;
+
+    if ( flashLogFlash.init() != 0 ) {
+        return false;
+    }
+
+    flashEnd = flashLogFlash.get_flash_start() + flashLogFlash.get_flash_size();
+    flashLogStartAddress = flashEnd - FLASH_LOG_SIZE;
+    if ( flashLogStartAddress % flashLogFlash.get_sector_size( flashLogStartAddress ) != 0 ||
+         FLASH_LOG_PAGE_SIZE % flashLogFlash.get_page_size() != 0 ) {
+        return false;
+    }
+
+    flashLogWritePage = 0;
+    flashLogNextSequence = 0;
+    for ( page = 0; page < FLASH_LOG_NUMBER_OF_PAGES; page++ ) {
+        flashLogFlash.read( headerBytes, flashLogPageAddress( page ), sizeof( headerBytes ) );
+        if ( flashLogPageHeaderRead( headerBytes, &header ) &&
+             ( !found || header.sequence >= flashLogNextSequence ) ) {
+            flashLogNextSequence = header.sequence + 1;
+            flashLogWritePage = ( page + 1 ) % FLASH_LOG_NUMBER_OF_PAGES;
+            found = true;
+        }
+    }
+
+    // Un corte durante el borrado deja basura a mitad de sector: se sigue
+    // desde el sector siguiente
+    page = flashLogWritePage;
+    if ( flashLogPageAddress( page ) % flashLogFlash.get_sector_size( flashLogPageAddress( page ) ) != 0 &&
+         !flashLogPageIsErased( page ) ) {
+        while ( flashLogPageAddress( page ) %
+                flashLogFlash.get_sector_size( flashLogPageAddress( page ) ) != 0 ) {
+            page = ( page + 1 ) % FLASH_LOG_NUMBER_OF_PAGES;
+        }
+        flashLogWritePage = page;
+    }
+
+    flashLogPageUsed = 0;
+    flashLogReady = true;
+    return true;
+}
+
+void flashLogSampleWrite( int tempCentiC, bool gasDetected )
+{
+    flashLogRecord_t record;
+
+    if ( tempCentiC > INT16_MAX ) {
+        tempCentiC = INT16_MAX;     // El fondo de escala del ADC es 330 grados
+    }
+
+    record.timeMs     = schedulerTimeMs();
+    record.tempCentiC = (int16_t) tempCentiC;
+    record.type       = FLASH_LOG_TAG_SAMPLE;
+    record.value      = gasDetected;
+    flashLogRecordPush( &record );
+}
+
+void flashLogEventWrite( flashLogEvent_t event )
+{
+    flashLogRecord_t record;
+
+    record.timeMs     = schedulerTimeMs();
+    record.tempCentiC = 0;
+    record.type       = FLASH_LOG_TAG_EVENT;
+    record.value      = (uint8_t) event;
+    flashLogRecordPush( &record );
+}
+
+// Graba solo paginas completas, o la pagina en curso si lleva
+// FLASH_LOG_FLUSH_PERIOD_MS abierta. El borrado de un sector de 128 KB
+// tarda del orden de un segundo; por eso corre en el hilo de telemetria y
+// el anillo esta en el banco 2, que se puede borrar mientras se ejecuta
+// codigo desde el banco 1.
+void flashLogUpdate()
+{
+    flashLogRecord_t record;
+
+    if ( !flashLogReady ) {
+        return;
+    }
+
+    while ( spscQueuePop( &flashLogQueue, &record ) ) {
+        flashLogRecordEncode( &record );
+    }
+
+    if ( flashLogPageUsed > 0 &&
+         schedulerTimeMs() - flashLogPageOpenedMs >= FLASH_LOG_FLUSH_PERIOD_MS ) {
+        flashLogPageFlush();
+    }
+}
+
+// Recorre el anillo desde la pagina mas vieja. Los registros que todavia
+// estan en la pagina en RAM salen en el volcado siguiente.
+void flashLogDumpStart()
+{
+    flashLogDumpPagesLeft = flashLogReady ? FLASH_LOG_NUMBER_OF_PAGES : 0;
+    flashLogDumpPageIndex = flashLogWritePage;
+    flashLogDumpOffset = FLASH_LOG_PAGE_SIZE;
+    flashLogDumpRecords = 0;
+    flashLogDumpBegun = false;
+    flashLogDumpActive = true;
+}
+
+// Escribe por la consola una linea por llamada, con
+// FLASH_LOG_LINE_MAX_LENGTH como maximo:
+//   LOG_BEGIN,<paginas>
+//   LOG,<ms>,SAMPLE,<temperatura>,<gas>
+//   LOG,<ms>,EVENT,<nombre>
+//   LOG_END,<registros>,<descartados>
+// Nunca espera a la flash: si el escritor esta borrando un sector (hasta
+// 2 s) retorna FLASH_LOG_DUMP_BUSY sin escribir, y la consola sigue atendida.
+flashLogDumpResult_t flashLogDumpLineWrite()
+{
+    bool busy = false;
+
+    if ( !flashLogDumpActive ) {
+        return FLASH_LOG_DUMP_DONE;
+    }
+
+    if ( !flashLogDumpBegun ) {
+        flashLogDumpBegun = true;
+        pcSerialComMessageBegin();
+        pcSerialComMessageString( "LOG_BEGIN," );
+        pcSerialComMessageUnsigned( FLASH_LOG_NUMBER_OF_PAGES );
+        pcSerialComMessageString( "\r\n" );
+        pcSerialComMessageEnd();
+        return FLASH_LOG_DUMP_LINE_WRITTEN;
+    }
+
+    while ( !flashLogDumpRecordDecode() ) {
+        if ( !flashLogDumpPageLoad( &busy ) ) {
+            if ( busy ) {
+                return FLASH_LOG_DUMP_BUSY;
+            }
+            flashLogDumpActive = false;
+            pcSerialComMessageBegin();
+            pcSerialComMessageString( "LOG_END," );
+            pcSerialComMessageUnsigned( flashLogDumpRecords );
+            pcSerialComMessageString( "," );
+            pcSerialComMessageUnsigned( flashLogDroppedCount );
+            pcSerialComMessageString( "\r\n" );
+            pcSerialComMessageEnd();
+            return FLASH_LOG_DUMP_LINE_WRITTEN;
+        }
+    }
+
+    flashLogDumpRecords++;
+    return FLASH_LOG_DUMP_LINE_WRITTEN;
+}
+
+// El FlashIAP del log y el FlashIAPBlockDevice de config_store pueden
+// compartir el mutex del driver: un borrado de cualquiera frenaria
+// flashLogFlash.read() en el hilo de consola. Con este mutex tomado por todos los que borran o
+// graban, el volcado lo prueba con trylock() y nunca llega a esperar.
+void flashLogFlashLock()
+{
+    flashLogMutex.lock();
+}
+
+void flashLogFlashUnlock()
+{
+    flashLogMutex.unlock();
+}
+
+uint32_t flashLogDroppedRecords()
+{
+    return flashLogDroppedCount;
+}
+
+//=====[Implementations of private functions]==================================
+
+static void flashLogRecordPush( const flashLogRecord_t* record )
+{
+    if ( !spscQueuePush( &flashLogQueue, *record ) ) {
+        flashLogDroppedCount++;
+    }
+}
+
+static void flashLogRecordEncode( const flashLogRecord_t* record )
+{
+    uint8_t* cursor;
+    int32_t tempDelta;
+
+    if ( flashLogPageUsed + FLASH_LOG_RECORD_MAX_SIZE > FLASH_LOG_PAGE_SIZE ) {
+        flashLogPageFlush();
+    }
+    if ( flashLogPageUsed == 0 ) {
+        flashLogPageOpen( record );
+    }
+
+    cursor = &flashLogPage[flashLogPageUsed];
+    if ( record->type == FLASH_LOG_TAG_SAMPLE ) {
+        *cursor++ = FLASH_LOG_TAG_SAMPLE | ( record->value ? FLASH_LOG_TAG_GAS : 0 );
+    } else {
+        *cursor++ = FLASH_LOG_TAG_EVENT | ( record->value << FLASH_LOG_TAG_EVENT_SHIFT );
+    }
+    cursor += flashLogVarintWrite( cursor, record->timeMs - flashLogPageLastTimeMs );
+    flashLogPageLastTimeMs = record->timeMs;
+
+    if ( record->type == FLASH_LOG_TAG_SAMPLE ) {
+        tempDelta = record->tempCentiC - flashLogPageLastTempCentiC;
+        cursor += flashLogVarintWrite( cursor, ( (uint32_t) tempDelta << 1 ) ^
+                                               (uint32_t) ( tempDelta >> 31 ) );
+        flashLogPageLastTempCentiC = record->tempCentiC;
+    }
+
+    flashLogPageUsed = cursor - flashLogPage;
+}
+
+static void flashLogPageOpen( const flashLogRecord_t* record )
+{
+    flashLogPageLastTimeMs = record->timeMs;
+    flashLogPageLastTempCentiC = record->type == FLASH_LOG_TAG_SAMPLE ?
+                                 record->tempCentiC : flashLogPageLastTempCentiC;
+    flashLogPageOpenedMs = schedulerTimeMs();
+
+    flashLogLittleEndianWrite( &flashLogPage[0], FLASH_LOG_MAGIC, 2 );
+    flashLogLittleEndianWrite( &flashLogPage[2], flashLogNextSequence, 4 );
+    flashLogLittleEndianWrite( &flashLogPage[6], flashLogPageLastTimeMs, 4 );
+    flashLogLittleEndianWrite( &flashLogPage[10], (uint16_t) flashLogPageLastTempCentiC, 2 );
+    flashLogLittleEndianWrite( &flashLogPage[12], 0xFFFF, 2 );
+    flashLogPageUsed = FLASH_LOG_HEADER_SIZE;
+}
+
+static void flashLogPageFlush()
+{
+    uint32_t address = flashLogPageAddress( flashLogWritePage );
+
+    memset( &flashLogPage[flashLogPageUsed], FLASH_LOG_ERASED_BYTE,
+            FLASH_LOG_PAGE_SIZE - flashLogPageUsed );
+
+    flashLogMutex.lock();
+    if ( address % flashLogFlash.get_sector_size( address ) == 0 ) {
+        flashLogFlash.erase( address, flashLogFlash.get_sector_size( address ) );
+    }
+    flashLogFlash.program( flashLogPage, address, FLASH_LOG_PAGE_SIZE );
+    flashLogMutex.unlock();
+
+    flashLogWritePage = ( flashLogWritePage + 1 ) % FLASH_LOG_NUMBER_OF_PAGES;
+    flashLogNextSequence++;
+    flashLogPageUsed = 0;
+}
+
+static uint32_t flashLogPageAddress( uint32_t page )
+{
+    return flashLogStartAddress + page * FLASH_LOG_PAGE_SIZE;
+}
+
+static bool flashLogPageHeaderRead( const uint8_t* page, flashLogPageHeader_t* header )
+{
+    if ( flashLogLittleEndianRead( &page[0], 2 ) != FLASH_LOG_MAGIC ) {
+        return false;
+    }
+    header->sequence   = flashLogLittleEndianRead( &page[2], 4 );
+    header->timeMs     = flashLogLittleEndianRead( &page[6], 4 );
+    header->tempCentiC = (int16_t) flashLogLittleEndianRead( &page[10], 2 );
+    return true;
+}
+
+static bool flashLogPageIsErased( uint32_t page )
+{
+    uint8_t buffer[FLASH_LOG_PAGE_SIZE];
+    int i;
+
+    flashLogFlash.read( buffer, flashLogPageAddress( page ), sizeof( buffer ) );
+    for ( i = 0; i < FLASH_LOG_PAGE_SIZE; i++ ) {
+        if ( buffer[i] != FLASH_LOG_ERASED_BYTE ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Carga la siguiente pagina valida del anillo. Las paginas borradas o que
+// se borran durante el volcado se saltean. Con el mutex tomado por
+// flashLogPageFlush() o por config_store no espera: retorna false con *busy
+// en true y la misma pagina se lee en el proximo intento. No se lee la flash
+// mapeada con memcpy: config_store esta en el mismo banco 2 y leerlo durante
+// un borrado frenaria el bus, y con el todo el micro.
+static bool flashLogDumpPageLoad( bool* busy )
+{
+    flashLogPageHeader_t header;
+
+    while ( flashLogDumpPagesLeft > 0 ) {
+        if ( !flashLogMutex.trylock() ) {
+            *busy = true;
+            return false;
+        }
+        flashLogFlash.read( flashLogDumpPage, flashLogPageAddress( flashLogDumpPageIndex ),
+                            FLASH_LOG_PAGE_SIZE );
+        flashLogMutex.unlock();
+
+        flashLogDumpPageIndex = ( flashLogDumpPageIndex + 1 ) % FLASH_LOG_NUMBER_OF_PAGES;
+        flashLogDumpPagesLeft--;
+
+        if ( flashLogPageHeaderRead( flashLogDumpPage, &header ) ) {
+            flashLogDumpOffset = FLASH_LOG_HEADER_SIZE;
+            flashLogDumpTimeMs = header.timeMs;
+            flashLogDumpTempCentiC = header.tempCentiC;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool flashLogDumpRecordDecode()
+{
+    const uint8_t* cursor = &flashLogDumpPage[flashLogDumpOffset];
+    int length = FLASH_LOG_PAGE_SIZE - flashLogDumpOffset;
+    uint32_t timeDelta;
+    uint32_t tempZigzag;
+    uint8_t tag;
+    int used;
+
+    if ( length <= 0 || *cursor == FLASH_LOG_ERASED_BYTE ) {
+        return false;
+    }
+    tag = *cursor++;
+    length--;
+
+    used = flashLogVarintRead( cursor, length, &timeDelta );
+    if ( used == 0 ) {
+        return false;
+    }
+    cursor += used;
+    length -= used;
+    flashLogDumpTimeMs += timeDelta;
+
+    if ( ( tag & FLASH_LOG_TAG_TYPE_MASK ) == FLASH_LOG_TAG_SAMPLE ) {
+        used = flashLogVarintRead( cursor, length, &tempZigzag );
+        if ( used == 0 ) {
+            return false;
+        }
+        cursor += used;
+        flashLogDumpTempCentiC += (int32_t) ( tempZigzag >> 1 ) ^ -(int32_t) ( tempZigzag & 1 );
+
+        pcSerialComMessageBegin();
+        pcSerialComMessageString( "LOG," );
+        pcSerialComMessageUnsigned( flashLogDumpTimeMs );
+        pcSerialComMessageString( ",SAMPLE," );
+        pcSerialComMessageCentesimal( flashLogDumpTempCentiC );
+        pcSerialComMessageString( ( tag & FLASH_LOG_TAG_GAS ) ? ",1\r\n" : ",0\r\n" );
+        pcSerialComMessageEnd();
+    } else {
+        int event = tag >> FLASH_LOG_TAG_EVENT_SHIFT;
+        pcSerialComMessageBegin();
+        pcSerialComMessageString( "LOG," );
+        pcSerialComMessageUnsigned( flashLogDumpTimeMs );
+        pcSerialComMessageString( ",EVENT," );
+        pcSerialComMessageString( event < FLASH_LOG_NUMBER_OF_EVENTS ?
+                                  flashLogEventNames[event] : "UNKNOWN" );
+        pcSerialComMessageString( "\r\n" );
+        pcSerialComMessageEnd();
+    }
+
+    flashLogDumpOffset = cursor - flashLogDumpPage;
+    return true;
+}
+
+// Enteros sin signo en base 128, siete bits por byte y el bit alto indica
+// que sigue otro byte: los deltas chicos ocupan uno solo.
+static int flashLogVarintWrite( uint8_t* buffer, uint32_t value )
+{
+    int length = 0;
+
+    while ( value >= 0x80 ) {
+        buffer[length++] = (uint8_t) ( value | 0x80 );
+        value >>= 7;
+    }
+    buffer[length++] = (uint8_t) value;
+    return length;
+}
+
+static int flashLogVarintRead( const uint8_t* buffer, int length, uint32_t* value )
+{
+    uint32_t result = 0;
+    int i;
+
+    for ( i = 0; i < length && i < 5; i++ ) {
+        result |= (uint32_t) ( buffer[i] & 0x7F ) << ( 7 * i );
+        if ( ( buffer[i] & 0x80 ) == 0 ) {
+            *value = result;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+static uint32_t flashLogLittleEndianRead( const uint8_t* buffer, int length )
+{
+    uint32_t value = 0;
+    int i;
+
+    for ( i = length - 1; i >= 0; i-- ) {
+        value = ( value << 8 ) | buffer[i];
+    }
+    return value;
+}
+
+static void flashLogLittleEndianWrite( uint8_t* buffer, uint32_t value, int length )
+{
+    int i;
+
+    for ( i = 0; i < length; i++ ) {
+        buffer[i] = (uint8_t) ( value >> ( 8 * i ) );
+    }
+}
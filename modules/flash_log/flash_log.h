@@ -0,0 +1,64 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _FLASH_LOG_H_
+#define _FLASH_LOG_H_
+
+//=====[Libraries]=============================================================
+
+#include <stdint.h>
+
+//=====[Declaration of public defines]=========================================
+
+#ifdef MBED_CONF_APP_FLASH_LOG_SIZE
+#define FLASH_LOG_SIZE                MBED_CONF_APP_FLASH_LOG_SIZE
+#else
+#define FLASH_LOG_SIZE                ( 256 * 1024 )  // Ultimos dos sectores de 128 KB
+#endif
+#define FLASH_LOG_PAGE_SIZE             256   // Unidad de escritura, con su propio encabezado
+#define FLASH_LOG_QUEUE_SIZE             32   // Potencia de 2
+#define FLASH_LOG_SAMPLE_PERIOD_MS     1000
+#define FLASH_LOG_FLUSH_PERIOD_MS     60000   // Maximo que un registro espera en RAM
+#define FLASH_LOG_LINE_MAX_LENGTH        64
+
+//=====[Declaration of public data types]======================================
+
+typedef enum {
+    FLASH_LOG_EVENT_BOOT,
+    FLASH_LOG_EVENT_ALARM_ON,
+    FLASH_LOG_EVENT_ALARM_OFF,
+    FLASH_LOG_EVENT_CODE_FAIL,
+    FLASH_LOG_EVENT_LOCKOUT,
+    FLASH_LOG_EVENT_WATCHDOG_RESET,     // El arranque vino de un reset del watchdog
+    FLASH_LOG_NUMBER_OF_EVENTS,
+} flashLogEvent_t;
+
+typedef enum {
+    FLASH_LOG_DUMP_LINE_WRITTEN,
+    FLASH_LOG_DUMP_BUSY,        // La flash se esta borrando; reintentar luego
+    FLASH_LOG_DUMP_DONE,        // No hay mas lineas
+} flashLogDumpResult_t;
+
+//=====[Declarations (prototypes) of public functions]=========================
+
+bool flashLogInit();
+
+// Productor: un unico hilo (el de alarma). No bloquean ni tocan la flash.
+void flashLogSampleWrite( int tempCentiC, bool gasDetected );
+void flashLogEventWrite( flashLogEvent_t event );
+
+// Escritor: arma las paginas y las graba, desde el hilo de menor prioridad
+void flashLogUpdate();
+
+// Todo otro borrado o grabacion de la flash en marcha (config_store) va
+// entre estas dos llamadas, para que el volcado no lo espere
+void flashLogFlashLock();
+void flashLogFlashUnlock();
+
+void flashLogDumpStart();
+flashLogDumpResult_t flashLogDumpLineWrite();
+
+uint32_t flashLogDroppedRecords();
+
+//=====[#include guards - end]=================================================
+
+#endif // _FLASH_LOG_H_
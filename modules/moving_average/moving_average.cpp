@@ -0,0 +1,44 @@
+//=====[Libraries]=============================================================
+
+#include "moving_average.h"
+
+//=====[Implementations of public functions]===================================
+
+void movingAverageInit( movingAverage_t* filter, uint16_t* buffer, int size )
+{
+    filter->samples = buffer;
+    filter->size    = size;
+    movingAverageReset( filter );
+}
+
+void movingAverageReset( movingAverage_t* filter )
+{
+    int i;
+
+    for ( i = 0; i < filter->size; i++ ) {
+        filter->samples[i] = 0;
+    }
+    filter->index = 0;
+    filter->sum   = 0;
+}
+
+// Costo constante por muestra: se suma la nueva y se resta la mas antigua.
+// Al ser una suma entera no acumula error de redondeo aunque corra horas.
+uint16_t movingAverageUpdate( movingAverage_t* filter, uint16_t newSample )
+{
+    filter->sum = filter->sum - filter->samples[filter->index] + newSample;
+
+    filter->samples[filter->index] = newSample;
+    filter->index++;
+    if ( filter->index >= filter->size ) {
+        filter->index = 0;
+    }
+
+    return movingAverageRead( filter );
+}
+
+// Promedio redondeado al entero mas cercano
+uint16_t movingAverageRead( const movingAverage_t* filter )
+{
+    return ( filter->sum + filter->size / 2 ) / filter->size;
+}
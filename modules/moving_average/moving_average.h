@@ -0,0 +1,35 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _MOVING_AVERAGE_H_
+#define _MOVING_AVERAGE_H_
+
+//=====[Libraries]=============================================================
+
+#include <stdint.h>
+
+//=====[Declaration of public defines]=========================================
+
+#define MOVING_AVERAGE_MAX_SIZE    65536   // La suma de 16 bits entra en 32 bits
+
+//=====[Declaration of public data types]======================================
+
+// Filtro de media movil incremental sobre muestras crudas de 16 bits. El
+// buffer de muestras lo provee quien usa el filtro, de modo que el tamaño
+// de ventana es configurable por instancia.
+typedef struct {
+    uint16_t* samples;    // Buffer circular de muestras (size elementos)
+    int size;             // Tamaño de la ventana
+    int index;            // Posicion de la muestra mas antigua
+    uint32_t sum;         // Suma corriente de la ventana, exacta
+} movingAverage_t;
+
+//=====[Declarations (prototypes) of public functions]=========================
+
+void movingAverageInit( movingAverage_t* filter, uint16_t* buffer, int size );
+void movingAverageReset( movingAverage_t* filter );
+uint16_t movingAverageUpdate( movingAverage_t* filter, uint16_t newSample );
+uint16_t movingAverageRead( const movingAverage_t* filter );
+
+//=====[#include guards - end]=================================================
+
+#endif // _MOVING_AVERAGE_H_
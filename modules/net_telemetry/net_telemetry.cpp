@@ -0,0 +1,429 @@
+//=====[Libraries]=============================================================
+
+#include "mbed.h"
+#include "arm_book_lib.h"
+
+#include "net_telemetry.h"
+#include "scheduler.h"
+#include "spsc_queue.h"
+
+#include <string.h>
+
+//=====[Declaration of private defines]========================================
+
+#define NET_TELEMETRY_VERSION               1
+#define NET_TELEMETRY_TYPE_EVENTS           1
+#define NET_TELEMETRY_TYPE_SUMMARIES        2
+
+#define NET_TELEMETRY_HEADER_LENGTH        13
+#define NET_TELEMETRY_EVENT_LENGTH          6
+#define NET_TELEMETRY_SUMMARY_LENGTH       22
+#define NET_TELEMETRY_MESSAGE_MAX_LENGTH    ( NET_TELEMETRY_HEADER_LENGTH + \
+                                              NET_TELEMETRY_SUMMARIES_PER_MESSAGE * \
+                                              NET_TELEMETRY_SUMMARY_LENGTH )
+
+//=====[Declaration of private data types]=====================================
+
+typedef struct {
+    uint32_t timeMs;
+    uint8_t event;
+    uint8_t status;
+} netTelemetryEvent_t;
+
+// Resumen de un periodo, con la salida del filtro de cada sensor
+typedef struct {
+    uint32_t startMs;
+    uint16_t samples;
+    int16_t tempMinCentiC;
+    int16_t tempMaxCentiC;
+    int16_t tempAvgCentiC;
+    uint16_t potentiometerMin;
+    uint16_t potentiometerMax;
+    uint16_t potentiometerAvg;
+    uint16_t gasSamples;            // Muestras con gas detectado
+    uint16_t alarmSamples;          // Muestras con la alarma activa
+} netTelemetrySummary_t;
+
+//=====[Declaration and initialization of private global objects]==============
+
+#if NET_TELEMETRY_ENABLED
+static NetworkInterface* netTelemetryInterface = NULL;
+static UDPSocket netTelemetrySocket;
+static SocketAddress netTelemetryCollector;
+#endif
+
+//=====[Declaration and initialization of private global variables]============
+
+static spscQueue_t<netTelemetryEvent_t, NET_TELEMETRY_EVENT_QUEUE_SIZE> netTelemetryEventQueue;
+static netTelemetryEvent_t netTelemetryEvents[NET_TELEMETRY_MAX_EVENTS_PER_MESSAGE];
+static int netTelemetryNumberOfEvents = 0;
+
+static netTelemetrySummary_t netTelemetrySummaries[NET_TELEMETRY_MAX_SUMMARIES];
+static int netTelemetryFirstSummary = 0;
+static int netTelemetryNumberOfSummaries = 0;
+
+// Periodo en curso
+static netTelemetrySummary_t netTelemetryCurrent;
+static int32_t netTelemetryTempSum = 0;
+static uint32_t netTelemetryPotentiometerSum = 0;
+
+// En RAM y no en la pila: el hilo de telemetria tiene poca
+static uint8_t netTelemetryMessage[NET_TELEMETRY_MESSAGE_MAX_LENGTH];
+static uint16_t netTelemetrySequence = 0;
+static uint32_t netTelemetryNodeId = NET_TELEMETRY_NODE_ID;
+
+static netTelemetryStats_t netTelemetryStats;
+#if NET_TELEMETRY_ENABLED
+static uint32_t netTelemetryAttemptTimeMs = 0;
+static uint32_t netTelemetryRetryDelayMs = NET_TELEMETRY_RETRY_MIN_MS;
+#endif
+
+static const char* const netTelemetryStateNames[] = {
+    "off", "disconnected", "connecting", "connected",
+};
+
+//=====[Declarations (prototypes) of private functions]========================
+
+static void netTelemetrySummaryStart( uint32_t startMs );
+static void netTelemetrySummaryClose();
+static void netTelemetryConnectionUpdate();
+static bool netTelemetryEventsSend();
+static bool netTelemetrySummariesSend();
+static uint8_t* netTelemetryHeaderWrite( uint8_t type, int count );
+static bool netTelemetryMessageSend( const uint8_t* end );
+static uint8_t* netTelemetryPut16( uint8_t* buffer, uint16_t value );
+static uint8_t* netTelemetryPut32( uint8_t* buffer, uint32_t value );
+
+//=====[Implementations of public functions]===================================
+
+void netTelemetryInit()
+{
+    spscQueueInit( &netTelemetryEventQueue );
+    memset( &netTelemetryStats, 0, sizeof( netTelemetryStats ) );
+    netTelemetryStats.state = NET_TELEMETRY_STATE_OFF;
+    netTelemetrySummaryStart( schedulerTimeMs() );
+
+#if NET_TELEMETRY_ENABLED
+#if defined( UID_BASE )
+    if ( netTelemetryNodeId == 0 ) {
+        const uint32_t* uid = (const uint32_t*) UID_BASE;
+        netTelemetryNodeId = uid[0] ^ uid[1] ^ uid[2];
+    }
+#endif
+
+    // Solo direcciones numericas: resolver un nombre bloquearia el hilo
+    netTelemetryInterface = NetworkInterface::get_default_instance();
+    if ( netTelemetryInterface == NULL ||
+         !netTelemetryCollector.set_ip_address( NET_TELEMETRY_COLLECTOR ) ) {
+        return;
+    }
+    netTelemetryCollector.set_port( NET_TELEMETRY_PORT );
+    netTelemetryInterface->set_blocking( false );
+
+    netTelemetryStats.state = NET_TELEMETRY_STATE_DISCONNECTED;
+    netTelemetryRetryDelayMs = 0;   // El primer intento sale enseguida
+#endif
+}
+
+void netTelemetryEventWrite( uint8_t event, uint8_t status )
+{
+    netTelemetryEvent_t record;
+
+    record.timeMs = schedulerTimeMs();
+    record.event = event;
+    record.status = status;
+    if ( !spscQueuePush( &netTelemetryEventQueue, record ) ) {
+        netTelemetryStats.droppedEvents++;
+    }
+}
+
+// El resumen se arma aunque no haya red; se guardan los ultimos
+// NET_TELEMETRY_MAX_SUMMARIES para enviarlos al reconectar
+void netTelemetrySampleWrite( int tempCentiC, uint16_t potentiometer, bool gasDetected,
+                              bool alarmActive )
+{
+    netTelemetrySummary_t* summary = &netTelemetryCurrent;
+
+    if ( summary->samples == UINT16_MAX ) {
+        return;
+    }
+    if ( tempCentiC > INT16_MAX ) {
+        tempCentiC = INT16_MAX;     // Solo con la entrada saturada, arriba de 327 C
+    }
+
+    if ( summary->samples == 0 ) {
+        summary->tempMinCentiC = summary->tempMaxCentiC = tempCentiC;
+        summary->potentiometerMin = summary->potentiometerMax = potentiometer;
+    }
+    if ( tempCentiC < summary->tempMinCentiC ) {
+        summary->tempMinCentiC = tempCentiC;
+    }
+    if ( tempCentiC > summary->tempMaxCentiC ) {
+        summary->tempMaxCentiC = tempCentiC;
+    }
+    if ( potentiometer < summary->potentiometerMin ) {
+        summary->potentiometerMin = potentiometer;
+    }
+    if ( potentiometer > summary->potentiometerMax ) {
+        summary->potentiometerMax = potentiometer;
+    }
+    netTelemetryTempSum += tempCentiC;
+    netTelemetryPotentiometerSum += potentiometer;
+    summary->gasSamples += gasDetected;
+    summary->alarmSamples += alarmActive;
+    summary->samples++;
+}
+
+// Nunca espera a la red: la conexion avanza con la interfaz en modo no
+// bloqueante y un envio que no entra se reintenta en el siguiente tick.
+// Los eventos salen antes que los resumenes.
+void netTelemetryUpdate()
+{
+    netTelemetryEvent_t record;
+
+    if ( schedulerTimeMs() - netTelemetryCurrent.startMs >= NET_TELEMETRY_SUMMARY_PERIOD_MS ) {
+        netTelemetrySummaryClose();
+    }
+
+    while ( netTelemetryNumberOfEvents < NET_TELEMETRY_MAX_EVENTS_PER_MESSAGE &&
+            spscQueuePop( &netTelemetryEventQueue, &record ) ) {
+        netTelemetryEvents[netTelemetryNumberOfEvents++] = record;
+    }
+
+    netTelemetryConnectionUpdate();
+    if ( netTelemetryStats.state != NET_TELEMETRY_STATE_CONNECTED ) {
+        return;
+    }
+
+    if ( netTelemetryEventsSend() ) {
+        netTelemetrySummariesSend();
+    }
+}
+
+void netTelemetryRead( netTelemetryStats_t* stats )
+{
+    *stats = netTelemetryStats;
+}
+
+const char* netTelemetryStateName( netTelemetryState_t state )
+{
+    return netTelemetryStateNames[state];
+}
+
+//=====[Implementations of private functions]==================================
+
+static void netTelemetrySummaryStart( uint32_t startMs )
+{
+    memset( &netTelemetryCurrent, 0, sizeof( netTelemetryCurrent ) );
+    netTelemetryCurrent.startMs = startMs;
+    netTelemetryTempSum = 0;
+    netTelemetryPotentiometerSum = 0;
+}
+
+// Si la cola esta llena se pierde el resumen mas viejo
+static void netTelemetrySummaryClose()
+{
+    netTelemetrySummary_t* summary = &netTelemetryCurrent;
+
+    if ( summary->samples > 0 ) {
+        summary->tempAvgCentiC = netTelemetryTempSum / summary->samples;
+        summary->potentiometerAvg = netTelemetryPotentiometerSum / summary->samples;
+
+        if ( netTelemetryNumberOfSummaries == NET_TELEMETRY_MAX_SUMMARIES ) {
+            netTelemetryFirstSummary = ( netTelemetryFirstSummary + 1 ) %
+                                       NET_TELEMETRY_MAX_SUMMARIES;
+            netTelemetryNumberOfSummaries--;
+            netTelemetryStats.droppedSummaries++;
+        }
+        netTelemetrySummaries[( netTelemetryFirstSummary + netTelemetryNumberOfSummaries ) %
+                              NET_TELEMETRY_MAX_SUMMARIES] = *summary;
+        netTelemetryNumberOfSummaries++;
+    }
+
+    netTelemetrySummaryStart( summary->startMs + NET_TELEMETRY_SUMMARY_PERIOD_MS );
+}
+
+// Reintentos con espera creciente hasta NET_TELEMETRY_RETRY_MAX_MS, para
+// que cientos de equipos no saturen la red al volver un switch
+static void netTelemetryConnectionUpdate()
+{
+#if NET_TELEMETRY_ENABLED
+    uint32_t currentTimeMs = schedulerTimeMs();
+    nsapi_connection_status_t status;
+    nsapi_error_t error;
+
+    if ( netTelemetryStats.state == NET_TELEMETRY_STATE_OFF ) {
+        return;
+    }
+
+    status = netTelemetryInterface->get_connection_status();
+
+    switch ( netTelemetryStats.state ) {
+    case NET_TELEMETRY_STATE_DISCONNECTED:
+        if ( currentTimeMs - netTelemetryAttemptTimeMs < netTelemetryRetryDelayMs ) {
+            return;
+        }
+        netTelemetryAttemptTimeMs = currentTimeMs;
+        if ( status != NSAPI_STATUS_GLOBAL_UP ) {
+            netTelemetryInterface->disconnect();
+            error = netTelemetryInterface->connect();
+            if ( error != NSAPI_ERROR_OK && error != NSAPI_ERROR_IN_PROGRESS &&
+                 error != NSAPI_ERROR_IS_CONNECTED && error != NSAPI_ERROR_BUSY ) {
+                break;
+            }
+        }
+        netTelemetryStats.state = NET_TELEMETRY_STATE_CONNECTING;
+        return;
+
+    case NET_TELEMETRY_STATE_CONNECTING:
+        if ( status == NSAPI_STATUS_GLOBAL_UP ) {
+            if ( netTelemetrySocket.open( netTelemetryInterface ) != NSAPI_ERROR_OK ) {
+                break;
+            }
+            netTelemetrySocket.set_blocking( false );
+            netTelemetryStats.state = NET_TELEMETRY_STATE_CONNECTED;
+            netTelemetryStats.connections++;
+            netTelemetryRetryDelayMs = NET_TELEMETRY_RETRY_MIN_MS;
+            return;
+        }
+        if ( currentTimeMs - netTelemetryAttemptTimeMs < NET_TELEMETRY_CONNECT_TIMEOUT_MS ) {
+            return;
+        }
+        break;
+
+    case NET_TELEMETRY_STATE_CONNECTED:
+        if ( status == NSAPI_STATUS_GLOBAL_UP ) {
+            return;
+        }
+        netTelemetrySocket.close();
+        netTelemetryAttemptTimeMs = currentTimeMs;
+        netTelemetryRetryDelayMs = NET_TELEMETRY_RETRY_MIN_MS;
+        netTelemetryStats.state = NET_TELEMETRY_STATE_DISCONNECTED;
+        return;
+
+    case NET_TELEMETRY_STATE_OFF:
+    default:
+        return;
+    }
+
+    // El intento fallo
+    netTelemetryRetryDelayMs = netTelemetryRetryDelayMs < NET_TELEMETRY_RETRY_MIN_MS ?
+                               NET_TELEMETRY_RETRY_MIN_MS : netTelemetryRetryDelayMs * 2;
+    if ( netTelemetryRetryDelayMs > NET_TELEMETRY_RETRY_MAX_MS ) {
+        netTelemetryRetryDelayMs = NET_TELEMETRY_RETRY_MAX_MS;
+    }
+    netTelemetryStats.state = NET_TELEMETRY_STATE_DISCONNECTED;
+#endif
+}
+
+// Retorna false si quedaron eventos sin enviar
+static bool netTelemetryEventsSend()
+{
+    uint8_t* buffer;
+    int i;
+
+    if ( netTelemetryNumberOfEvents == 0 ) {
+        return true;
+    }
+
+    buffer = netTelemetryHeaderWrite( NET_TELEMETRY_TYPE_EVENTS, netTelemetryNumberOfEvents );
+    for ( i = 0; i < netTelemetryNumberOfEvents; i++ ) {
+        buffer = netTelemetryPut32( buffer, netTelemetryEvents[i].timeMs );
+        *buffer++ = netTelemetryEvents[i].event;
+        *buffer++ = netTelemetryEvents[i].status;
+    }
+
+    if ( !netTelemetryMessageSend( buffer ) ) {
+        return false;
+    }
+    netTelemetryNumberOfEvents = 0;
+    return true;
+}
+
+// Un mensaje por llamada con los NET_TELEMETRY_SUMMARIES_PER_MESSAGE mas
+// viejos; tras una desconexion larga se ponen al dia de a un mensaje por tick
+static bool netTelemetrySummariesSend()
+{
+    const netTelemetrySummary_t* summary;
+    uint8_t* buffer;
+    int i;
+
+    if ( netTelemetryNumberOfSummaries < NET_TELEMETRY_SUMMARIES_PER_MESSAGE ) {
+        return true;
+    }
+
+    buffer = netTelemetryHeaderWrite( NET_TELEMETRY_TYPE_SUMMARIES,
+                                      NET_TELEMETRY_SUMMARIES_PER_MESSAGE );
+    for ( i = 0; i < NET_TELEMETRY_SUMMARIES_PER_MESSAGE; i++ ) {
+        summary = &netTelemetrySummaries[( netTelemetryFirstSummary + i ) %
+                                         NET_TELEMETRY_MAX_SUMMARIES];
+        buffer = netTelemetryPut32( buffer, summary->startMs );
+        buffer = netTelemetryPut16( buffer, summary->samples );
+        buffer = netTelemetryPut16( buffer, summary->tempMinCentiC );
+        buffer = netTelemetryPut16( buffer, summary->tempMaxCentiC );
+        buffer = netTelemetryPut16( buffer, summary->tempAvgCentiC );
+        buffer = netTelemetryPut16( buffer, summary->potentiometerMin );
+        buffer = netTelemetryPut16( buffer, summary->potentiometerMax );
+        buffer = netTelemetryPut16( buffer, summary->potentiometerAvg );
+        buffer = netTelemetryPut16( buffer, summary->gasSamples );
+        buffer = netTelemetryPut16( buffer, summary->alarmSamples );
+    }
+
+    if ( !netTelemetryMessageSend( buffer ) ) {
+        return false;
+    }
+    netTelemetryFirstSummary = ( netTelemetryFirstSummary + NET_TELEMETRY_SUMMARIES_PER_MESSAGE ) %
+                               NET_TELEMETRY_MAX_SUMMARIES;
+    netTelemetryNumberOfSummaries -= NET_TELEMETRY_SUMMARIES_PER_MESSAGE;
+    return true;
+}
+
+// Encabezado, little endian: version, tipo, secuencia, nodo, tiempo desde
+// el arranque y cantidad de registros. La secuencia solo avanza con los
+// envios aceptados, asi el colector distingue los datagramas perdidos.
+static uint8_t* netTelemetryHeaderWrite( uint8_t type, int count )
+{
+    uint8_t* buffer = netTelemetryMessage;
+
+    *buffer++ = NET_TELEMETRY_VERSION;
+    *buffer++ = type;
+    buffer = netTelemetryPut16( buffer, netTelemetrySequence );
+    buffer = netTelemetryPut32( buffer, netTelemetryNodeId );
+    buffer = netTelemetryPut32( buffer, schedulerTimeMs() );
+    *buffer++ = count;
+
+    return buffer;
+}
+
+static bool netTelemetryMessageSend( const uint8_t* end )
+{
+#if NET_TELEMETRY_ENABLED
+    nsapi_size_or_error_t result;
+
+    result = netTelemetrySocket.sendto( netTelemetryCollector, netTelemetryMessage,
+                                        end - netTelemetryMessage );
+    if ( result < 0 ) {
+        netTelemetryStats.sendErrors++;
+        return false;
+    }
+
+    netTelemetrySequence++;
+    netTelemetryStats.messagesSent++;
+    return true;
+#else
+    return false;
+#endif
+}
+
+static uint8_t* netTelemetryPut16( uint8_t* buffer, uint16_t value )
+{
+    buffer[0] = value & 0xFF;
+    buffer[1] = value >> 8;
+    return buffer + 2;
+}
+
+static uint8_t* netTelemetryPut32( uint8_t* buffer, uint32_t value )
+{
+    buffer = netTelemetryPut16( buffer, value & 0xFFFF );
+    return netTelemetryPut16( buffer, value >> 16 );
+}
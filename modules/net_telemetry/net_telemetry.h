@@ -0,0 +1,89 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _NET_TELEMETRY_H_
+#define _NET_TELEMETRY_H_
+
+//=====[Libraries]=============================================================
+
+#include <stdint.h>
+
+//=====[Declaration of public defines]=========================================
+
+#ifdef MBED_CONF_APP_NET_TELEMETRY
+#define NET_TELEMETRY_ENABLED               MBED_CONF_APP_NET_TELEMETRY
+#else
+#define NET_TELEMETRY_ENABLED               0   // Sin red: el modulo no hace nada
+#endif
+#ifdef MBED_CONF_APP_NET_TELEMETRY_COLLECTOR
+#define NET_TELEMETRY_COLLECTOR             MBED_CONF_APP_NET_TELEMETRY_COLLECTOR
+#else
+#define NET_TELEMETRY_COLLECTOR             "192.168.1.10"
+#endif
+#ifdef MBED_CONF_APP_NET_TELEMETRY_PORT
+#define NET_TELEMETRY_PORT                  MBED_CONF_APP_NET_TELEMETRY_PORT
+#else
+#define NET_TELEMETRY_PORT                  40100
+#endif
+#ifdef MBED_CONF_APP_NET_TELEMETRY_NODE_ID
+#define NET_TELEMETRY_NODE_ID               MBED_CONF_APP_NET_TELEMETRY_NODE_ID
+#else
+#define NET_TELEMETRY_NODE_ID               0   // 0 usa el ID unico del micro
+#endif
+#ifdef MBED_CONF_APP_NET_TELEMETRY_SUMMARY_PERIOD_MS
+#define NET_TELEMETRY_SUMMARY_PERIOD_MS     MBED_CONF_APP_NET_TELEMETRY_SUMMARY_PERIOD_MS
+#else
+#define NET_TELEMETRY_SUMMARY_PERIOD_MS     10000
+#endif
+#define NET_TELEMETRY_SUMMARIES_PER_MESSAGE     6
+#define NET_TELEMETRY_MAX_SUMMARIES            12   // Pendientes mientras no hay red
+#define NET_TELEMETRY_EVENT_QUEUE_SIZE         16   // Potencia de 2
+#define NET_TELEMETRY_MAX_EVENTS_PER_MESSAGE    8
+#define NET_TELEMETRY_CONNECT_TIMEOUT_MS    15000
+#define NET_TELEMETRY_RETRY_MIN_MS           1000
+#define NET_TELEMETRY_RETRY_MAX_MS          60000
+
+// Bits del estado que acompana a cada evento
+#define NET_TELEMETRY_STATUS_ALARM          ( 1 << 0 )
+#define NET_TELEMETRY_STATUS_GAS            ( 1 << 1 )
+#define NET_TELEMETRY_STATUS_OVER_TEMP      ( 1 << 2 )
+
+//=====[Declaration of public data types]======================================
+
+typedef enum {
+    NET_TELEMETRY_STATE_OFF,            // Deshabilitado en mbed_app.json
+    NET_TELEMETRY_STATE_DISCONNECTED,   // Esperando para reintentar
+    NET_TELEMETRY_STATE_CONNECTING,     // Enlace y DHCP en curso
+    NET_TELEMETRY_STATE_CONNECTED,
+} netTelemetryState_t;
+
+typedef struct {
+    netTelemetryState_t state;
+    uint32_t messagesSent;
+    uint32_t sendErrors;
+    uint32_t connections;
+    uint32_t droppedEvents;         // Cola de eventos llena
+    uint32_t droppedSummaries;      // Los mas viejos, tras mucho tiempo sin red
+} netTelemetryStats_t;
+
+//=====[Declarations (prototypes) of public functions]=========================
+
+// Desde main(), antes del primer evento. Solo prepara la interfaz: la
+// conexion la hace netTelemetryUpdate() desde el hilo de telemetria.
+void netTelemetryInit();
+
+// Productor: un unico hilo (el de alarma), o main() antes del scheduler.
+// Solo encola; el evento sale en el siguiente netTelemetryUpdate().
+void netTelemetryEventWrite( uint8_t event, uint8_t status );
+
+// Desde el hilo de telemetria, en cada tick: acumula el resumen y atiende
+// la conexion sin bloquear
+void netTelemetrySampleWrite( int tempCentiC, uint16_t potentiometer, bool gasDetected,
+                              bool alarmActive );
+void netTelemetryUpdate();
+
+void netTelemetryRead( netTelemetryStats_t* stats );
+const char* netTelemetryStateName( netTelemetryState_t state );
+
+//=====[#include guards - end]=================================================
+
+#endif // _NET_TELEMETRY_H_
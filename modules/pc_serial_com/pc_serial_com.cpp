@@ -0,0 +1,250 @@
+//=====[Libraries]=============================================================
+
+#include "mbed.h"
+#include "arm_book_lib.h"
+
+#include "pc_serial_com.h"
+#include "text_format.h"
+
+//=====[Declaration of private defines]========================================
+
+#define PC_SERIAL_COM_RX_BUFFER_MASK    ( PC_SERIAL_COM_RX_BUFFER_SIZE - 1 )
+#define PC_SERIAL_COM_TX_BUFFER_MASK    ( PC_SERIAL_COM_TX_BUFFER_SIZE - 1 )
+
+//=====[Declaration and initialization of private global objects]==============
+
+static UnbufferedSerial uartUsb( USBTX, USBRX, PC_SERIAL_COM_BAUD_RATE );
+
+// Escriben la consola y la telemetria desde hilos distintos
+static Mutex pcSerialComTxMutex;
+
+//=====[Declaration and initialization of private global variables]============
+
+// Buffer circular de recepcion: lo llena la interrupcion de RX y lo vacia
+// la tarea de la consola, cada uno moviendo solo su propio indice.
+static char pcSerialComRxBuffer[PC_SERIAL_COM_RX_BUFFER_SIZE];
+static volatile uint32_t pcSerialComRxHead = 0;
+static volatile uint32_t pcSerialComRxTail = 0;
+
+static pcSerialComRxCallback_t pcSerialComRxCallback = NULL;
+
+// Buffer circular de transmision: lo llenan las tareas y lo vacia la
+// interrupcion de TX, que solo esta habilitada mientras haya datos.
+static char pcSerialComTxBuffer[PC_SERIAL_COM_TX_BUFFER_SIZE];
+static volatile uint32_t pcSerialComTxHead = 0;
+static volatile uint32_t pcSerialComTxTail = 0;
+static volatile bool pcSerialComTxIrqEnabled = false;
+static uint32_t pcSerialComTxDroppedCount = 0;
+
+// Mensaje en armado: avanza sobre el buffer sin publicar pcSerialComTxHead
+static uint32_t pcSerialComMessageHead = 0;
+static bool pcSerialComMessageOverflow = false;
+
+//=====[Declarations (prototypes) of private functions]========================
+
+static void pcSerialComRxIsr();
+static void pcSerialComTxIsr();
+static void pcSerialComMessageAppend( const char* data, int length );
+static void pcSerialComTxPublish( uint32_t head );
+
+//=====[Implementations of public functions]===================================
+
+void pcSerialComInit( pcSerialComRxCallback_t rxCallback )
+{
+    pcSerialComRxCallback = rxCallback;
+    uartUsb.attach( &pcSerialComRxIsr, SerialBase::RxIrq );
+}
+
+// No bloquea: devuelve false si no hay caracteres pendientes.
+bool pcSerialComCharRead( char* receivedChar )
+{
+    uint32_t tail = pcSerialComRxTail;
+
+    if ( tail == pcSerialComRxHead ) {
+        return false;
+    }
+
+    *receivedChar = pcSerialComRxBuffer[tail & PC_SERIAL_COM_RX_BUFFER_MASK];
+    pcSerialComRxTail = tail + 1;
+    return true;
+}
+
+void pcSerialComStringWrite( const char* str )
+{
+    pcSerialComWrite( str, strlen( str ) );
+}
+
+void pcSerialComCharWrite( char charToWrite )
+{
+    pcSerialComWrite( &charToWrite, 1 );
+}
+
+// Encola el mensaje y retorna sin esperar a que se transmita. Si no entra
+// completo se descarta entero, para no mezclar respuestas truncadas en la
+// consola, y se contabiliza en pcSerialComTxDroppedMessages(). No debe
+// llamarse desde interrupciones.
+bool pcSerialComWrite( const char* data, int length )
+{
+    uint32_t head;
+    int i;
+
+    pcSerialComTxMutex.lock();
+
+    head = pcSerialComTxHead;
+    if ( PC_SERIAL_COM_TX_BUFFER_SIZE - ( head - pcSerialComTxTail ) < (uint32_t) length ) {
+        pcSerialComTxDroppedCount++;
+        pcSerialComTxMutex.unlock();
+        return false;
+    }
+
+    for ( i = 0; i < length; i++ ) {
+        pcSerialComTxBuffer[( head + i ) & PC_SERIAL_COM_TX_BUFFER_MASK] = data[i];
+    }
+    pcSerialComTxPublish( head + length );
+
+    pcSerialComTxMutex.unlock();
+    return true;
+}
+
+void pcSerialComMessageBegin()
+{
+    pcSerialComTxMutex.lock();
+    pcSerialComMessageHead = pcSerialComTxHead;
+    pcSerialComMessageOverflow = false;
+}
+
+void pcSerialComMessageString( const char* str )
+{
+    pcSerialComMessageAppend( str, strlen( str ) );
+}
+
+void pcSerialComMessageUnsigned( uint32_t value )
+{
+    char digits[TEXT_FORMAT_NUMBER_MAX_LENGTH];
+
+    pcSerialComMessageAppend( digits, textFormatUnsigned( digits, value ) );
+}
+
+void pcSerialComMessageSigned( int32_t value )
+{
+    char digits[TEXT_FORMAT_NUMBER_MAX_LENGTH];
+
+    pcSerialComMessageAppend( digits, textFormatSigned( digits, value ) );
+}
+
+void pcSerialComMessageCentesimal( int32_t centesimalValue )
+{
+    char digits[TEXT_FORMAT_NUMBER_MAX_LENGTH];
+
+    pcSerialComMessageAppend( digits, textFormatCentesimal( digits, centesimalValue ) );
+}
+
+void pcSerialComMessageHex( uint32_t value, int digits )
+{
+    char hexDigits[TEXT_FORMAT_NUMBER_MAX_LENGTH];
+
+    pcSerialComMessageAppend( hexDigits, textFormatHex( hexDigits, value, digits ) );
+}
+
+bool pcSerialComMessageEnd()
+{
+    bool sent = !pcSerialComMessageOverflow;
+
+    if ( sent ) {
+        pcSerialComTxPublish( pcSerialComMessageHead );
+    } else {
+        pcSerialComTxDroppedCount++;
+    }
+
+    pcSerialComTxMutex.unlock();
+    return sent;
+}
+
+uint32_t pcSerialComTxDroppedMessages()
+{
+    return pcSerialComTxDroppedCount;
+}
+
+// Lugar libre en el buffer de TX, para que un volcado largo espere en vez
+// de perder mensajes
+int pcSerialComTxFree()
+{
+    return PC_SERIAL_COM_TX_BUFFER_SIZE - (int) ( pcSerialComTxHead - pcSerialComTxTail );
+}
+
+// true cuando todo lo encolado ya paso al registro de datos de la UART
+bool pcSerialComTxIdle()
+{
+    return !pcSerialComTxIrqEnabled;
+}
+
+//=====[Implementations of private functions]==================================
+
+static void pcSerialComMessageAppend( const char* data, int length )
+{
+    uint32_t head = pcSerialComMessageHead;
+    int i;
+
+    if ( pcSerialComMessageOverflow ||
+         PC_SERIAL_COM_TX_BUFFER_SIZE - ( head - pcSerialComTxTail ) < (uint32_t) length ) {
+        pcSerialComMessageOverflow = true;
+        return;
+    }
+
+    for ( i = 0; i < length; i++ ) {
+        pcSerialComTxBuffer[( head + i ) & PC_SERIAL_COM_TX_BUFFER_MASK] = data[i];
+    }
+    pcSerialComMessageHead = head + length;
+}
+
+// Publica lo escrito hasta head y habilita la interrupcion de TX. Se llama
+// con el mutex tomado.
+static void pcSerialComTxPublish( uint32_t head )
+{
+    core_util_critical_section_enter();
+    pcSerialComTxHead = head;
+    if ( !pcSerialComTxIrqEnabled ) {
+        pcSerialComTxIrqEnabled = true;
+        uartUsb.attach( &pcSerialComTxIsr, SerialBase::TxIrq );
+    }
+    core_util_critical_section_exit();
+}
+
+// Hay que leer el dato dentro de la interrupcion; si no, la bandera de RX
+// queda activa y la interrupcion se vuelve a disparar indefinidamente.
+static void pcSerialComRxIsr()
+{
+    char receivedChar;
+
+    while ( uartUsb.readable() ) {
+        uartUsb.read( &receivedChar, 1 );
+
+        uint32_t head = pcSerialComRxHead;
+        if ( head - pcSerialComRxTail < PC_SERIAL_COM_RX_BUFFER_SIZE ) {
+            pcSerialComRxBuffer[head & PC_SERIAL_COM_RX_BUFFER_MASK] = receivedChar;
+            pcSerialComRxHead = head + 1;
+        }
+    }
+
+    if ( pcSerialComRxCallback != NULL ) {
+        pcSerialComRxCallback();
+    }
+}
+
+// La interrupcion de TX se dispara mientras el registro de datos este vacio,
+// asi que se deshabilita al vaciar el buffer.
+static void pcSerialComTxIsr()
+{
+    uint32_t tail = pcSerialComTxTail;
+
+    while ( tail != pcSerialComTxHead && uartUsb.writable() ) {
+        uartUsb.write( &pcSerialComTxBuffer[tail & PC_SERIAL_COM_TX_BUFFER_MASK], 1 );
+        tail++;
+    }
+    pcSerialComTxTail = tail;
+
+    if ( tail == pcSerialComTxHead ) {
+        uartUsb.attach( NULL, SerialBase::TxIrq );
+        pcSerialComTxIrqEnabled = false;
+    }
+}
@@ -0,0 +1,49 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _PC_SERIAL_COM_H_
+#define _PC_SERIAL_COM_H_
+
+//=====[Libraries]=============================================================
+
+#include <stdint.h>
+
+//=====[Declaration of public defines]=========================================
+
+#ifdef MBED_CONF_APP_CONSOLE_BAUD_RATE
+#define PC_SERIAL_COM_BAUD_RATE        MBED_CONF_APP_CONSOLE_BAUD_RATE
+#else
+#define PC_SERIAL_COM_BAUD_RATE        115200
+#endif
+#define PC_SERIAL_COM_RX_BUFFER_SIZE       64   // Potencia de 2
+#define PC_SERIAL_COM_TX_BUFFER_SIZE     1024   // Potencia de 2
+
+//=====[Declaration of public data types]======================================
+
+typedef void (*pcSerialComRxCallback_t)();
+
+//=====[Declarations (prototypes) of public functions]=========================
+
+void pcSerialComInit( pcSerialComRxCallback_t rxCallback );
+bool pcSerialComCharRead( char* receivedChar );
+void pcSerialComStringWrite( const char* str );
+void pcSerialComCharWrite( char charToWrite );
+bool pcSerialComWrite( const char* data, int length );
+
+// Mensaje armado por partes directamente en el buffer de TX, sin buffer
+// intermedio ni printf. Entre Begin y End el hilo tiene el buffer tomado;
+// si el mensaje no entra completo, End lo descarta entero y retorna false.
+void pcSerialComMessageBegin();
+void pcSerialComMessageString( const char* str );
+void pcSerialComMessageUnsigned( uint32_t value );
+void pcSerialComMessageSigned( int32_t value );
+void pcSerialComMessageCentesimal( int32_t centesimalValue );
+void pcSerialComMessageHex( uint32_t value, int digits );
+bool pcSerialComMessageEnd();
+
+uint32_t pcSerialComTxDroppedMessages();
+bool pcSerialComTxIdle();
+int pcSerialComTxFree();
+
+//=====[#include guards - end]=================================================
+
+#endif // _PC_SERIAL_COM_H_
@@ -0,0 +1,44 @@
+//=====[Libraries]=============================================================
+
+#include "mbed.h"
+#include "arm_book_lib.h"
+
+#include "power_monitor.h"
+
+//=====[Declaration of private defines]========================================
+
+#define POWER_MONITOR_US_PER_S    1000000
+
+//=====[Declarations (prototypes) of private functions]========================
+
+static int powerMonitorCentiPercent( uint64_t partUs, uint64_t totalUs );
+
+//=====[Implementations of public functions]===================================
+
+// Requiere "platform.cpu-stats-enabled" en mbed_app.json; el kernel acumula
+// los tiempos en cada entrada y salida del hilo idle.
+void powerMonitorRead( powerMonitorReport_t* report )
+{
+    mbed_stats_cpu_t stats;
+
+    mbed_stats_cpu_get( &stats );
+
+    report->uptimeS = (uint32_t) ( stats.uptime / POWER_MONITOR_US_PER_S );
+    report->awakeCentiPercent =
+        powerMonitorCentiPercent( stats.uptime - stats.idle_time, stats.uptime );
+    report->sleepCentiPercent =
+        powerMonitorCentiPercent( stats.sleep_time, stats.uptime );
+    report->deepSleepCentiPercent =
+        powerMonitorCentiPercent( stats.deep_sleep_time, stats.uptime );
+    report->deepSleepAllowed = sleep_manager_can_deep_sleep();
+}
+
+//=====[Implementations of private functions]==================================
+
+static int powerMonitorCentiPercent( uint64_t partUs, uint64_t totalUs )
+{
+    if ( totalUs == 0 ) {
+        return 0;
+    }
+    return (int) ( ( partUs * 10000 + totalUs / 2 ) / totalUs );
+}
@@ -0,0 +1,27 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _POWER_MONITOR_H_
+#define _POWER_MONITOR_H_
+
+//=====[Libraries]=============================================================
+
+#include <stdint.h>
+
+//=====[Declaration of public data types]======================================
+
+// Reparto del tiempo desde el arranque, en centesimas de porcentaje
+typedef struct {
+    uint32_t uptimeS;
+    int awakeCentiPercent;        // CPU ejecutando codigo
+    int sleepCentiPercent;        // WFI, perifericos y relojes encendidos
+    int deepSleepCentiPercent;    // STOP, solo el reloj de bajo consumo
+    bool deepSleepAllowed;        // Ningun driver bloquea el deep sleep ahora
+} powerMonitorReport_t;
+
+//=====[Declarations (prototypes) of public functions]=========================
+
+void powerMonitorRead( powerMonitorReport_t* report );
+
+//=====[#include guards - end]=================================================
+
+#endif // _POWER_MONITOR_H_
@@ -0,0 +1,150 @@
+//=====[Libraries]=============================================================
+
+#include "mbed.h"
+#include "arm_book_lib.h"
+
+#include "scheduler.h"
+#include "task_timing.h"
+
+//=====[Declaration of private defines]========================================
+
+#define SCHEDULER_QUEUE_EVENTS           ( SCHEDULER_MAX_TASKS + 16 )
+
+#define SCHEDULER_ALARM_STACK_SIZE       2048
+#define SCHEDULER_TELEMETRY_STACK_SIZE   1536
+
+//=====[Declaration of private data types]=====================================
+
+typedef struct {
+    const char* name;
+    int periodMs;
+    schedulerContext_t context;
+    schedulerTaskFunction_t function;
+    int timingProbe;            // Sonda de task_timing, con el periodo como presupuesto
+} schedulerTask_t;
+
+//=====[Declaration and initialization of private global objects]==============
+
+static EventQueue schedulerAlarmQueue( SCHEDULER_QUEUE_EVENTS * EVENTS_EVENT_SIZE );
+static EventQueue schedulerConsoleQueue( SCHEDULER_QUEUE_EVENTS * EVENTS_EVENT_SIZE );
+static EventQueue schedulerTelemetryQueue( SCHEDULER_QUEUE_EVENTS * EVENTS_EVENT_SIZE );
+
+static Thread schedulerAlarmThread( osPriorityHigh, SCHEDULER_ALARM_STACK_SIZE,
+                                    NULL, "alarm" );
+static Thread schedulerTelemetryThread( osPriorityLow, SCHEDULER_TELEMETRY_STACK_SIZE,
+                                        NULL, "telemetry" );
+
+//=====[Declaration and initialization of private global variables]============
+
+static EventQueue* const schedulerQueues[SCHEDULER_NUMBER_OF_CONTEXTS] = {
+    &schedulerAlarmQueue,
+    &schedulerConsoleQueue,
+    &schedulerTelemetryQueue,
+};
+
+static schedulerTask_t schedulerTasks[SCHEDULER_MAX_TASKS];
+static int schedulerNumberOfTasks = 0;
+
+static volatile uint32_t schedulerDroppedPostCount = 0;
+
+//=====[Declarations (prototypes) of private functions]========================
+
+static void schedulerTaskRun( int taskIndex );
+static bool schedulerPostResult( int eventId );
+
+//=====[Implementations of public functions]===================================
+
+void schedulerInit()
+{
+    schedulerNumberOfTasks = 0;
+}
+
+// Las tareas periodicas se reprograman sobre su instante teorico de
+// activacion y no sobre el fin de la ejecucion anterior, por lo que el
+// periodo no deriva aunque alguna tarea se demore.
+int schedulerAddPeriodicTask( schedulerContext_t context, const char* name,
+                              int periodMs, schedulerTaskFunction_t function )
+{
+    if ( schedulerNumberOfTasks >= SCHEDULER_MAX_TASKS ) {
+        return -1;
+    }
+
+    int taskIndex = schedulerNumberOfTasks;
+    schedulerTasks[taskIndex].name     = name;
+    schedulerTasks[taskIndex].periodMs = periodMs;
+    schedulerTasks[taskIndex].context  = context;
+    schedulerTasks[taskIndex].function = function;
+    schedulerTasks[taskIndex].timingProbe =
+        taskTimingProbeAdd( name, (uint32_t) periodMs * 1000 );
+    schedulerNumberOfTasks++;
+
+    schedulerQueues[context]->call_every( std::chrono::milliseconds( periodMs ),
+                                          schedulerTaskRun, taskIndex );
+
+    return taskIndex;
+}
+
+// Puede llamarse desde una interrupcion o desde otro hilo: la funcion se
+// ejecuta luego en el hilo del contexto indicado.
+bool schedulerPost( schedulerContext_t context, schedulerTaskFunction_t function )
+{
+    return schedulerPostResult( schedulerQueues[context]->call( function ) );
+}
+
+// Como schedulerPost(), pero la funcion corre recien despues de delayMs
+bool schedulerPostDelayed( schedulerContext_t context, int delayMs,
+                           schedulerTaskFunction_t function )
+{
+    return schedulerPostResult(
+        schedulerQueues[context]->call_in( std::chrono::milliseconds( delayMs ), function ) );
+}
+
+// Funciones que no entraron en la cola de su contexto desde el arranque
+uint32_t schedulerDroppedPosts()
+{
+    return schedulerDroppedPostCount;
+}
+
+// Arranca los hilos de alarma y telemetria y atiende la consola desde el
+// hilo main, que baja su prioridad. No retorna.
+void schedulerRun()
+{
+    schedulerAlarmThread.start( callback( &schedulerAlarmQueue,
+                                          &EventQueue::dispatch_forever ) );
+    schedulerTelemetryThread.start( callback( &schedulerTelemetryQueue,
+                                              &EventQueue::dispatch_forever ) );
+
+    osThreadSetPriority( ThisThread::get_id(), osPriorityBelowNormal );
+    schedulerConsoleQueue.dispatch_forever();
+}
+
+uint32_t schedulerTimeMs()
+{
+    return (uint32_t) Kernel::Clock::now().time_since_epoch().count();
+}
+
+//=====[Implementations of private functions]==================================
+
+static void schedulerTaskRun( int taskIndex )
+{
+    uint32_t startCycles = taskTimingStart();
+
+    schedulerTasks[taskIndex].function();
+
+    taskTimingStop( schedulerTasks[taskIndex].timingProbe, startCycles );
+}
+
+// EventQueue::call() retorna 0 cuando no hay lugar para el evento. El
+// contador se incrementa en seccion critica porque lo tocan interrupciones
+// e hilos de distinta prioridad.
+static bool schedulerPostResult( int eventId )
+{
+    if ( eventId != 0 ) {
+        return true;
+    }
+
+    core_util_critical_section_enter();
+    schedulerDroppedPostCount++;
+    core_util_critical_section_exit();
+    return false;
+}
@@ -0,0 +1,45 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _SCHEDULER_H_
+#define _SCHEDULER_H_
+
+//=====[Libraries]=============================================================
+
+#include <stdint.h>
+
+//=====[Declaration of public defines]=========================================
+
+#define SCHEDULER_MAX_TASKS    12
+
+//=====[Declaration of public data types]======================================
+
+// Cada contexto es una cola de eventos atendida por su propio hilo, con su
+// propia prioridad. Las tareas de un mismo contexto nunca se interrumpen
+// entre si; las de contextos distintos si.
+typedef enum {
+    SCHEDULER_CONTEXT_ALARM,       // Sensores y alarma, prioridad alta
+    SCHEDULER_CONTEXT_CONSOLE,     // Consola por UART, prioridad baja (hilo main)
+    SCHEDULER_CONTEXT_TELEMETRY,   // Telemetria, la menor prioridad
+    SCHEDULER_NUMBER_OF_CONTEXTS,
+} schedulerContext_t;
+
+typedef void (*schedulerTaskFunction_t)();
+
+//=====[Declarations (prototypes) of public functions]=========================
+
+void schedulerInit();
+int schedulerAddPeriodicTask( schedulerContext_t context, const char* name,
+                              int periodMs, schedulerTaskFunction_t function );
+// Retornan false si la cola del contexto estaba llena y la funcion no se
+// encolo; quien espere la ejecucion para limpiar un flag debe limpiarlo aca
+bool schedulerPost( schedulerContext_t context, schedulerTaskFunction_t function );
+bool schedulerPostDelayed( schedulerContext_t context, int delayMs,
+                           schedulerTaskFunction_t function );
+uint32_t schedulerDroppedPosts();
+void schedulerRun();
+
+uint32_t schedulerTimeMs();
+
+//=====[#include guards - end]=================================================
+
+#endif // _SCHEDULER_H_
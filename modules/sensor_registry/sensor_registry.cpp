@@ -0,0 +1,482 @@
+//=====[Libraries]=============================================================
+
+#include "mbed.h"
+#include "arm_book_lib.h"
+
+#include "sensor_registry.h"
+#include "alarm_config.h"
+#include "task_timing.h"
+
+//=====[Declaration of private defines]========================================
+
+// numberOfAvgSamples cuenta conversiones del ADC y cada muestra de un canal
+// de temperatura ya promedia ADC_SAMPLER_OVERSAMPLING
+#define SENSOR_REGISTRY_WINDOW_SAMPLES( conversions )  \
+    ( ( (conversions) + ADC_SAMPLER_OVERSAMPLING / 2 ) / ADC_SAMPLER_OVERSAMPLING > 0 ? \
+      ( (conversions) + ADC_SAMPLER_OVERSAMPLING / 2 ) / ADC_SAMPLER_OVERSAMPLING : 1 )
+#define SENSOR_REGISTRY_MAX_WINDOW           SENSOR_REGISTRY_WINDOW_SAMPLES( alarmConfig::numberOfAvgSamples )
+#define SENSOR_REGISTRY_NUMBER_OF_FILTERED   sensorRegistryKindCount( SENSOR_KIND_TEMPERATURE )
+#define SENSOR_REGISTRY_FILTERED_SIZE        ( SENSOR_REGISTRY_NUMBER_OF_FILTERED > 0 ? \
+                                               SENSOR_REGISTRY_NUMBER_OF_FILTERED : 1 )
+
+#define SENSOR_REGISTRY_SEED_READINGS        16   // Conversiones que cargan la ventana al arrancar
+
+// La subida se mide sobre una ventana deslizante que avanza de a un tramo
+#define SENSOR_REGISTRY_RISE_SLOTS           10
+#define SENSOR_REGISTRY_RISE_SLOT_SAMPLES    ( ADC_SAMPLER_RATE_HZ * SENSOR_REGISTRY_RISE_WINDOW_MS / \
+                                               1000 / SENSOR_REGISTRY_RISE_SLOTS > 0 ? \
+                                               ADC_SAMPLER_RATE_HZ * SENSOR_REGISTRY_RISE_WINDOW_MS / \
+                                               1000 / SENSOR_REGISTRY_RISE_SLOTS : 1 )
+#define SENSOR_REGISTRY_RISE_SAMPLES         ( SENSOR_REGISTRY_RISE_SLOTS * \
+                                               SENSOR_REGISTRY_RISE_SLOT_SAMPLES )
+
+//=====[Declaration of private data types]=====================================
+
+typedef struct {
+    const char* name;
+    sensorKind_t kind;
+    PinName pin;
+    int zone;               // 0: el canal no pertenece a ninguna zona
+} sensorRegistryChannel_t;
+
+//=====[Declarations (prototypes) of private functions]========================
+
+static void sensorRegistryFilterSeed( const uint16_t* readings );
+static void sensorRegistryRiseLimitUpdate( sensorKind_t kind );
+static void sensorRegistryRawUpdate( const adcSample_t* sample );
+static void sensorRegistryActiveUpdate();
+static bool sensorRegistryTemperatureActive( int channel, bool wasActive );
+
+//=====[Declaration and initialization of private global variables]============
+
+// Una fila por canal, en el orden de sensorChannel_t
+static constexpr sensorRegistryChannel_t sensorRegistryChannels[SENSOR_NUMBER_OF_CHANNELS] = {
+    { "zone1_temp",    SENSOR_KIND_TEMPERATURE, A1,    1 },
+    { "zone1_gas",     SENSOR_KIND_GAS,         PE_12, 1 },
+    { "potentiometer", SENSOR_KIND_ANALOG,      A0,    0 },
+};
+
+// Se resuelven al compilar a partir de la tabla y dimensionan los arreglos
+// que siguen, por eso estan aca y no con el resto de las funciones.
+static constexpr bool sensorRegistryKindIsAnalog( sensorKind_t kind )
+{
+    return kind != SENSOR_KIND_GAS;
+}
+
+static constexpr int sensorRegistryKindCount( sensorKind_t kind )
+{
+    int count = 0;
+    int channel = 0;
+
+    for ( channel = 0; channel < SENSOR_NUMBER_OF_CHANNELS; channel++ ) {
+        if ( sensorRegistryChannels[channel].kind == kind ) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+// El estado de los canales esta en arreglos paralelos (estructura de
+// arreglos) y no en una estructura por canal: cada lazo recorre un solo
+// arreglo contiguo y el costo crece linealmente con la cantidad de canales.
+static uint8_t sensorRegistryInputs[SENSOR_NUMBER_OF_CHANNELS];   // Indice en analog[] o bit de digital
+static uint16_t sensorRegistryRaw[SENSOR_NUMBER_OF_CHANNELS];     // Ultima lectura (digital: 0 o 1)
+static uint16_t sensorRegistryValues[SENSOR_NUMBER_OF_CHANNELS];  // Promedio o lectura segun el tipo
+static uint8_t sensorRegistryFilters[SENSOR_NUMBER_OF_CHANNELS];  // Columna de la ventana, si tiene
+static sensorDetection_t sensorRegistryDetections[SENSOR_NUMBER_OF_KINDS];
+static int32_t sensorRegistryRiseSumLimits[SENSOR_NUMBER_OF_KINDS];   // riseLimit en unidades de sensorRegistryRises
+static uint32_t sensorRegistryKindMasks[SENSOR_NUMBER_OF_KINDS];
+static volatile uint32_t sensorRegistryActiveMask = 0;
+
+// Instante en que se activo cada canal, en ciclos de taskTimingStart(): el
+// flanco de la entrada en los digitales y la primera muestra del lote en que
+// se detecto en el resto, una cota superior del cruce real del umbral.
+static uint32_t sensorRegistryActivationCycles[SENSOR_NUMBER_OF_CHANNELS];
+static uint32_t sensorRegistryBatchCycles = 0;
+static bool sensorRegistryBatchOpen = false;
+
+// Promedio movil de los canales de temperatura. Todos se muestrean en el
+// mismo instante, asi que comparten el indice de la ventana y cada muestra
+// ocupa una fila con un valor por canal.
+static uint8_t sensorRegistryFilteredChannels[SENSOR_REGISTRY_FILTERED_SIZE];
+static uint8_t sensorRegistryFilteredInputs[SENSOR_REGISTRY_FILTERED_SIZE];
+static uint32_t sensorRegistrySums[SENSOR_REGISTRY_FILTERED_SIZE];
+static uint16_t sensorRegistryHistory[SENSOR_REGISTRY_MAX_WINDOW][SENSOR_REGISTRY_FILTERED_SIZE];
+static int sensorRegistryHistoryIndex = 0;
+static int sensorRegistryWindow = SENSOR_REGISTRY_MAX_WINDOW;   // Filas en uso de la ventana
+
+// Subida de cada promedio, calculada de forma incremental a partir de la
+// suma de la ventana: cada SENSOR_REGISTRY_RISE_SLOT_SAMPLES muestras se
+// guarda la suma y la subida es la diferencia con la guardada
+// SENSOR_REGISTRY_RISE_SLOTS tramos antes. Al promedio le basta una
+// fraccion de la ventana para mostrar un incendio rapido, mucho antes de
+// llegar al umbral.
+static uint32_t sensorRegistryRiseSums[SENSOR_REGISTRY_RISE_SLOTS][SENSOR_REGISTRY_FILTERED_SIZE];
+static int32_t sensorRegistryRises[SENSOR_REGISTRY_FILTERED_SIZE];   // Suma actual menos la de hace RISE_SAMPLES
+static int sensorRegistryRiseSlot = 0;
+static int sensorRegistryRiseSlotCount = 0;
+
+//=====[Implementations of public functions]===================================
+
+// Arma las listas de entradas a partir de la tabla de canales y arranca el
+// muestreo. La ventana se carga con una rafaga de conversiones, asi los
+// promedios valen desde el arranque y no suben desde cero durante una
+// ventana entera. Los umbrales arrancan en el maximo, sin deteccion.
+void sensorRegistryInit( adcSamplerDigitalCallback_t digitalEdgeCallback )
+{
+    PinName analogPins[ADC_SAMPLER_MAX_ANALOG];
+    int analogOversampling[ADC_SAMPLER_MAX_ANALOG];
+    PinName digitalPins[ADC_SAMPLER_MAX_DIGITAL];
+    uint16_t seed[SENSOR_REGISTRY_FILTERED_SIZE];
+    adcSample_t sample;
+    int numberOfAnalog = 0;
+    int numberOfDigital = 0;
+    int numberOfFiltered = 0;
+    int channel;
+    int kind;
+    int i;
+
+    static_assert( sensorRegistryKindCount( SENSOR_KIND_TEMPERATURE ) +
+                   sensorRegistryKindCount( SENSOR_KIND_ANALOG ) <= ADC_SAMPLER_MAX_ANALOG,
+                   "Mas canales analogicos que entradas de adc_sampler" );
+    static_assert( sensorRegistryKindCount( SENSOR_KIND_GAS ) <= ADC_SAMPLER_MAX_DIGITAL,
+                   "Mas canales digitales que entradas de adc_sampler" );
+
+    for ( kind = 0; kind < SENSOR_NUMBER_OF_KINDS; kind++ ) {
+        sensorRegistryDetections[kind].onLevel = 0xFFFF;
+        sensorRegistryDetections[kind].offLevel = 0xFFFF;
+        sensorRegistryDetections[kind].riseLimit = 0;
+        sensorRegistryRiseSumLimits[kind] = 0;
+        sensorRegistryKindMasks[kind] = 0;
+    }
+
+    for ( channel = 0; channel < SENSOR_NUMBER_OF_CHANNELS; channel++ ) {
+        const sensorRegistryChannel_t* descriptor = &sensorRegistryChannels[channel];
+
+        sensorRegistryKindMasks[descriptor->kind] |= SENSOR_CHANNEL_MASK( channel );
+        if ( sensorRegistryKindIsAnalog( descriptor->kind ) ) {
+            sensorRegistryInputs[channel] = numberOfAnalog;
+            analogOversampling[numberOfAnalog] = descriptor->kind == SENSOR_KIND_TEMPERATURE ?
+                                                 ADC_SAMPLER_OVERSAMPLING : 1;
+            analogPins[numberOfAnalog++] = descriptor->pin;
+        } else {
+            sensorRegistryInputs[channel] = numberOfDigital;
+            digitalPins[numberOfDigital++] = descriptor->pin;
+        }
+        if ( descriptor->kind == SENSOR_KIND_TEMPERATURE ) {
+            sensorRegistryFilters[channel] = numberOfFiltered;
+            sensorRegistryFilteredChannels[numberOfFiltered] = channel;
+            sensorRegistryFilteredInputs[numberOfFiltered] = sensorRegistryInputs[channel];
+            numberOfFiltered++;
+        }
+    }
+
+    sensorRegistryActiveMask = 0;
+    memset( sensorRegistryActivationCycles, 0, sizeof( sensorRegistryActivationCycles ) );
+    sensorRegistryBatchOpen = false;
+
+    adcSamplerInit( analogPins, analogOversampling, numberOfAnalog,
+                    digitalPins, numberOfDigital, digitalEdgeCallback );
+
+    adcSamplerBurstRead( &sample, SENSOR_REGISTRY_SEED_READINGS );
+    for ( i = 0; i < numberOfFiltered; i++ ) {
+        seed[i] = sample.analog[sensorRegistryFilteredInputs[i]];
+    }
+    sensorRegistryFilterSeed( seed );
+    sensorRegistryBatchCycles = sample.cycles;
+    sensorRegistryRawUpdate( &sample );
+    sensorRegistryUpdate();
+    sensorRegistryDigitalRefresh();
+}
+
+// Por ahora solo los canales de temperatura usan la deteccion configurada.
+// Se aplica en el momento sobre los valores del ultimo lote.
+void sensorRegistryDetectionWrite( sensorKind_t kind, const sensorDetection_t* detection )
+{
+    sensorRegistryDetections[kind] = *detection;
+    sensorRegistryRiseLimitUpdate( kind );
+    sensorRegistryActiveUpdate();
+}
+
+// Ventana del promedio movil en conversiones del ADC, hasta la de
+// alarm_config.h que dimensiona los arreglos; se redondea al multiplo de
+// ADC_SAMPLER_OVERSAMPLING mas cercano. La ventana nueva arranca cargada con
+// el promedio actual, sin muestras de mas ni de menos.
+void sensorRegistryWindowWrite( int conversions )
+{
+    uint16_t seed[SENSOR_REGISTRY_FILTERED_SIZE];
+    int samples = SENSOR_REGISTRY_WINDOW_SAMPLES( conversions );
+    int kind;
+    int i;
+
+    if ( samples > SENSOR_REGISTRY_MAX_WINDOW ) {
+        samples = SENSOR_REGISTRY_MAX_WINDOW;
+    }
+
+    for ( i = 0; i < SENSOR_REGISTRY_NUMBER_OF_FILTERED; i++ ) {
+        seed[i] = ( sensorRegistrySums[i] + sensorRegistryWindow / 2 ) / sensorRegistryWindow;
+    }
+    sensorRegistryWindow = samples;
+    sensorRegistryFilterSeed( seed );
+    for ( kind = 0; kind < SENSOR_NUMBER_OF_KINDS; kind++ ) {
+        sensorRegistryRiseLimitUpdate( (sensorKind_t) kind );
+    }
+}
+
+// Costo constante por muestra y por canal: cada promedio suma la lectura
+// nueva y resta la de la misma columna en la fila mas antigua.
+void sensorRegistrySampleWrite( const adcSample_t* sample )
+{
+    uint16_t* row = sensorRegistryHistory[sensorRegistryHistoryIndex];
+    uint16_t reading;
+    int i;
+
+    if ( !sensorRegistryBatchOpen ) {
+        sensorRegistryBatchCycles = sample->cycles;
+        sensorRegistryBatchOpen = true;
+    }
+
+    for ( i = 0; i < SENSOR_REGISTRY_NUMBER_OF_FILTERED; i++ ) {
+        reading = sample->analog[sensorRegistryFilteredInputs[i]];
+        sensorRegistrySums[i] = sensorRegistrySums[i] - row[i] + reading;
+        row[i] = reading;
+    }
+
+    sensorRegistryHistoryIndex++;
+    if ( sensorRegistryHistoryIndex >= sensorRegistryWindow ) {
+        sensorRegistryHistoryIndex = 0;
+    }
+
+    sensorRegistryRiseSlotCount++;
+    if ( sensorRegistryRiseSlotCount >= SENSOR_REGISTRY_RISE_SLOT_SAMPLES ) {
+        uint32_t* slot = sensorRegistryRiseSums[sensorRegistryRiseSlot];
+
+        for ( i = 0; i < SENSOR_REGISTRY_NUMBER_OF_FILTERED; i++ ) {
+            sensorRegistryRises[i] = (int32_t) ( sensorRegistrySums[i] - slot[i] );
+            slot[i] = sensorRegistrySums[i];
+        }
+        sensorRegistryRiseSlotCount = 0;
+        sensorRegistryRiseSlot++;
+        if ( sensorRegistryRiseSlot >= SENSOR_REGISTRY_RISE_SLOTS ) {
+            sensorRegistryRiseSlot = 0;
+        }
+    }
+
+    sensorRegistryRawUpdate( sample );
+}
+
+// Una vez por lote de muestras: valores y deteccion de todos los canales
+void sensorRegistryUpdate()
+{
+    int channel;
+    int i;
+
+    for ( channel = 0; channel < SENSOR_NUMBER_OF_CHANNELS; channel++ ) {
+        sensorRegistryValues[channel] = sensorRegistryRaw[channel];
+    }
+    for ( i = 0; i < SENSOR_REGISTRY_NUMBER_OF_FILTERED; i++ ) {
+        sensorRegistryValues[sensorRegistryFilteredChannels[i]] =
+            ( sensorRegistrySums[i] + sensorRegistryWindow / 2 ) / sensorRegistryWindow;
+    }
+
+    sensorRegistryActiveUpdate();
+    sensorRegistryBatchOpen = false;
+}
+
+// Ante un flanco de una entrada digital, sin esperar al proximo lote
+void sensorRegistryDigitalRefresh()
+{
+    uint32_t levels = adcSamplerDigitalRead();
+    int channel;
+
+    for ( channel = 0; channel < SENSOR_NUMBER_OF_CHANNELS; channel++ ) {
+        if ( !sensorRegistryKindIsAnalog( sensorRegistryChannels[channel].kind ) ) {
+            sensorRegistryRaw[channel] = ( levels >> sensorRegistryInputs[channel] ) & 1;
+            sensorRegistryValues[channel] = sensorRegistryRaw[channel];
+        }
+    }
+
+    sensorRegistryActiveUpdate();
+}
+
+// Valor al ultimo lote: el promedio en los canales de temperatura y la
+// ultima lectura en el resto
+uint16_t sensorRegistryRead( sensorChannel_t channel )
+{
+    return sensorRegistryValues[channel];
+}
+
+// Como sensorRegistryRead(), pero los promedios incluyen hasta la ultima
+// muestra escrita y no solo hasta el ultimo lote
+uint16_t sensorRegistryAverageRead( sensorChannel_t channel )
+{
+    if ( sensorRegistryChannels[channel].kind != SENSOR_KIND_TEMPERATURE ) {
+        return sensorRegistryValues[channel];
+    }
+    return ( sensorRegistrySums[sensorRegistryFilters[channel]] + sensorRegistryWindow / 2 )
+           / sensorRegistryWindow;
+}
+
+uint16_t sensorRegistryRawRead( sensorChannel_t channel )
+{
+    return sensorRegistryRaw[channel];
+}
+
+// Velocidad de subida del promedio en cuentas por segundo; 0 en los canales
+// sin promedio
+int32_t sensorRegistryRiseRead( sensorChannel_t channel )
+{
+    if ( sensorRegistryChannels[channel].kind != SENSOR_KIND_TEMPERATURE ) {
+        return 0;
+    }
+    return (int32_t) ( (int64_t) sensorRegistryRises[sensorRegistryFilters[channel]] *
+                       ADC_SAMPLER_RATE_HZ /
+                       ( sensorRegistryWindow * SENSOR_REGISTRY_RISE_SAMPLES ) );
+}
+
+// Un bit por canal, ver SENSOR_CHANNEL_MASK()
+uint32_t sensorRegistryActiveChannels()
+{
+    return sensorRegistryActiveMask;
+}
+
+uint32_t sensorRegistryKindChannels( sensorKind_t kind )
+{
+    return sensorRegistryKindMasks[kind];
+}
+
+// Instante de activacion del primero de los canales activos de ese tipo, o
+// el instante actual si no hay ninguno
+uint32_t sensorRegistryActivationCyclesRead( sensorKind_t kind )
+{
+    uint32_t activeMask = sensorRegistryActiveMask & sensorRegistryKindMasks[kind];
+    uint32_t now = taskTimingStart();
+    uint32_t oldest = now;
+    int channel;
+
+    for ( channel = 0; channel < SENSOR_NUMBER_OF_CHANNELS; channel++ ) {
+        if ( ( activeMask & SENSOR_CHANNEL_MASK( channel ) ) &&
+             now - sensorRegistryActivationCycles[channel] > now - oldest ) {
+            oldest = sensorRegistryActivationCycles[channel];
+        }
+    }
+
+    return oldest;
+}
+
+const char* sensorRegistryName( sensorChannel_t channel )
+{
+    return sensorRegistryChannels[channel].name;
+}
+
+sensorKind_t sensorRegistryKind( sensorChannel_t channel )
+{
+    return sensorRegistryChannels[channel].kind;
+}
+
+int sensorRegistryZone( sensorChannel_t channel )
+{
+    return sensorRegistryChannels[channel].zone;
+}
+
+//=====[Implementations of private functions]==================================
+
+// Llena la ventana y el historial de sumas como si cada canal hubiera
+// leido siempre readings[i]: el promedio arranca en ese valor y la subida en
+// cero, y la deteccion por subida mide desde aca sin esperar a que se llenen.
+static void sensorRegistryFilterSeed( const uint16_t* readings )
+{
+    int row;
+    int slot;
+    int i;
+
+    for ( i = 0; i < SENSOR_REGISTRY_NUMBER_OF_FILTERED; i++ ) {
+        for ( row = 0; row < sensorRegistryWindow; row++ ) {
+            sensorRegistryHistory[row][i] = readings[i];
+        }
+        sensorRegistrySums[i] = (uint32_t) readings[i] * sensorRegistryWindow;
+        for ( slot = 0; slot < SENSOR_REGISTRY_RISE_SLOTS; slot++ ) {
+            sensorRegistryRiseSums[slot][i] = sensorRegistrySums[i];
+        }
+        sensorRegistryRises[i] = 0;
+    }
+    sensorRegistryHistoryIndex = 0;
+    sensorRegistryRiseSlot = 0;
+    sensorRegistryRiseSlotCount = 0;
+}
+
+// riseLimit pasado a unidades de sensorRegistryRises, que depende de la ventana
+static void sensorRegistryRiseLimitUpdate( sensorKind_t kind )
+{
+    sensorRegistryRiseSumLimits[kind] = (int32_t)
+        ( (uint64_t) sensorRegistryDetections[kind].riseLimit * sensorRegistryWindow *
+          SENSOR_REGISTRY_RISE_SAMPLES / ADC_SAMPLER_RATE_HZ );
+}
+
+static void sensorRegistryRawUpdate( const adcSample_t* sample )
+{
+    int channel;
+
+    for ( channel = 0; channel < SENSOR_NUMBER_OF_CHANNELS; channel++ ) {
+        if ( sensorRegistryKindIsAnalog( sensorRegistryChannels[channel].kind ) ) {
+            sensorRegistryRaw[channel] = sample->analog[sensorRegistryInputs[channel]];
+        } else {
+            sensorRegistryRaw[channel] = ( sample->digital >> sensorRegistryInputs[channel] ) & 1;
+        }
+    }
+}
+
+// Cada canal conserva su estado mientras su valor este dentro de la banda
+// de histeresis, asi el ruido cerca del umbral no lo hace oscilar.
+static void sensorRegistryActiveUpdate()
+{
+    uint32_t previous = sensorRegistryActiveMask;
+    uint32_t active = 0;
+    bool channelActive;
+    int channel;
+
+    for ( channel = 0; channel < SENSOR_NUMBER_OF_CHANNELS; channel++ ) {
+        switch ( sensorRegistryChannels[channel].kind ) {
+        case SENSOR_KIND_TEMPERATURE:
+            channelActive = sensorRegistryTemperatureActive(
+                                channel, previous & SENSOR_CHANNEL_MASK( channel ) );
+            break;
+        case SENSOR_KIND_GAS:
+            channelActive = sensorRegistryValues[channel] == 0;
+            break;
+        default:
+            channelActive = false;
+            break;
+        }
+        if ( channelActive ) {
+            active |= SENSOR_CHANNEL_MASK( channel );
+            if ( !( previous & SENSOR_CHANNEL_MASK( channel ) ) ) {
+                sensorRegistryActivationCycles[channel] =
+                    sensorRegistryKindIsAnalog( sensorRegistryChannels[channel].kind ) ?
+                    sensorRegistryBatchCycles :
+                    adcSamplerDigitalEdgeCyclesRead( sensorRegistryInputs[channel] );
+            }
+        }
+    }
+
+    sensorRegistryActiveMask = active;
+}
+
+static bool sensorRegistryTemperatureActive( int channel, bool wasActive )
+{
+    const sensorDetection_t* detection = &sensorRegistryDetections[SENSOR_KIND_TEMPERATURE];
+    int32_t riseSumLimit = sensorRegistryRiseSumLimits[SENSOR_KIND_TEMPERATURE];
+    int32_t rise = sensorRegistryRises[sensorRegistryFilters[channel]];
+    uint16_t value = sensorRegistryValues[channel];
+    bool rising = false;
+
+    if ( riseSumLimit > 0 ) {
+        rising = rise > ( wasActive ? riseSumLimit / 2 : riseSumLimit );
+    }
+
+    if ( wasActive ) {
+        return value > detection->offLevel || rising;
+    }
+    return value > detection->onLevel || rising;
+}
@@ -0,0 +1,72 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _SENSOR_REGISTRY_H_
+#define _SENSOR_REGISTRY_H_
+
+//=====[Libraries]=============================================================
+
+#include <stdint.h>
+
+#include "adc_sampler.h"
+
+//=====[Declaration of public defines]=========================================
+
+#define SENSOR_CHANNEL_MASK( channel )    ( 1UL << ( channel ) )
+
+#define SENSOR_REGISTRY_RISE_WINDOW_MS     250   // Intervalo sobre el que se mide la subida
+
+//=====[Declaration of public data types]======================================
+
+// Canales de la placa, en el orden de la tabla de sensor_registry.cpp. Para
+// vigilar otra zona alcanza con agregar aca sus canales y su fila en la
+// tabla: el muestreo, el filtrado y la deteccion los recorren a todos.
+typedef enum {
+    SENSOR_CHANNEL_ZONE1_TEMPERATURE,   // LM35 en A1
+    SENSOR_CHANNEL_ZONE1_GAS,           // Salida digital del MQ-2 en PE_12
+    SENSOR_CHANNEL_POTENTIOMETER,       // Potenciometro en A0
+    SENSOR_NUMBER_OF_CHANNELS,
+} sensorChannel_t;
+
+typedef enum {
+    SENSOR_KIND_TEMPERATURE,    // Analogica con promedio movil, umbral sobre el promedio
+    SENSOR_KIND_GAS,            // Digital activa en bajo
+    SENSOR_KIND_ANALOG,         // Analogica sin filtrar ni umbral
+    SENSOR_NUMBER_OF_KINDS,
+} sensorKind_t;
+
+// Deteccion sobre el promedio, en las mismas unidades que las lecturas
+// crudas. Un canal se activa al superar onLevel o al subir mas rapido que
+// riseLimit, y se desactiva recien cuando baja hasta offLevel y la subida
+// cae por debajo de la mitad de riseLimit.
+typedef struct {
+    uint16_t onLevel;
+    uint16_t offLevel;
+    uint16_t riseLimit;     // Cuentas por segundo; 0 deshabilita la deteccion por subida
+} sensorDetection_t;
+
+//=====[Declarations (prototypes) of public functions]=========================
+
+void sensorRegistryInit( adcSamplerDigitalCallback_t digitalEdgeCallback );
+void sensorRegistryDetectionWrite( sensorKind_t kind, const sensorDetection_t* detection );
+void sensorRegistryWindowWrite( int conversions );
+
+// Desde el hilo de alarma: una vez por muestra adquirida y una vez por lote
+void sensorRegistrySampleWrite( const adcSample_t* sample );
+void sensorRegistryUpdate();
+void sensorRegistryDigitalRefresh();
+
+uint16_t sensorRegistryRead( sensorChannel_t channel );
+uint16_t sensorRegistryAverageRead( sensorChannel_t channel );
+uint16_t sensorRegistryRawRead( sensorChannel_t channel );
+int32_t sensorRegistryRiseRead( sensorChannel_t channel );
+uint32_t sensorRegistryActiveChannels();
+uint32_t sensorRegistryKindChannels( sensorKind_t kind );
+uint32_t sensorRegistryActivationCyclesRead( sensorKind_t kind );
+
+const char* sensorRegistryName( sensorChannel_t channel );
+sensorKind_t sensorRegistryKind( sensorChannel_t channel );
+int sensorRegistryZone( sensorChannel_t channel );
+
+//=====[#include guards - end]=================================================
+
+#endif // _SENSOR_REGISTRY_H_
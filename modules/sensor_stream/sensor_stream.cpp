@@ -0,0 +1,218 @@
+//=====[Libraries]=============================================================
+
+#include "mbed.h"
+#include "arm_book_lib.h"
+
+#include "sensor_stream.h"
+#include "pc_serial_com.h"
+#include "spsc_queue.h"
+
+//=====[Declaration of private defines]========================================
+
+// Trama, en little endian:
+//
+//   0xA5 0x5A          sincronismo
+//   longitud u16       bytes desde tipo hasta el ultimo dato
+//   tipo u8            SENSOR_STREAM_FRAME_SAMPLES
+//   canales u8         mascara de los canales presentes
+//   cantidad u8        muestras en la trama
+//   indice u32         numero de la primera muestra; las de una trama son
+//                      consecutivas y un salto indica muestras descartadas
+//   muestras           cada una con los canales presentes, en el orden de
+//                      sensorStreamChannel_t
+//   crc u16            CRC-16 CCITT de longitud, tipo, canales... muestras
+//
+// La consola ASCII comparte la UART, asi que el receptor se sincroniza con
+// 0xA5 0x5A y descarta las tramas cuyo CRC no coincide.
+#define SENSOR_STREAM_SYNC_0                 0xA5
+#define SENSOR_STREAM_SYNC_1                 0x5A
+#define SENSOR_STREAM_FRAME_SAMPLES          0x01
+#define SENSOR_STREAM_PREFIX_SIZE               4   // Sincronismo y longitud
+#define SENSOR_STREAM_BODY_HEADER_SIZE          7   // Tipo, canales, cantidad, indice
+#define SENSOR_STREAM_CRC_SIZE                  2
+#define SENSOR_STREAM_MAX_SAMPLE_SIZE           7
+#define SENSOR_STREAM_MAX_FRAME_SIZE    ( SENSOR_STREAM_PREFIX_SIZE + \
+                                          SENSOR_STREAM_BODY_HEADER_SIZE + \
+                                          SENSOR_STREAM_MAX_SAMPLES_PER_FRAME * \
+                                          SENSOR_STREAM_MAX_SAMPLE_SIZE + \
+                                          SENSOR_STREAM_CRC_SIZE )
+
+#define SENSOR_STREAM_ALL_CHANNELS    ( SENSOR_STREAM_CHANNEL_MASK( SENSOR_STREAM_NUMBER_OF_CHANNELS ) - 1 )
+
+//=====[Declaration of private data types]=====================================
+
+typedef struct {
+    uint32_t index;             // Numero de muestra, cuenta tambien las descartadas
+    uint16_t lm35;
+    uint16_t potentiometer;
+    uint16_t lm35Filtered;
+    bool mq2;
+} sensorStreamSample_t;
+
+//=====[Declaration and initialization of private global objects]==============
+
+static MbedCRC<POLY_16BIT_CCITT, 16> sensorStreamCrc;
+
+//=====[Declaration and initialization of private global variables]============
+
+static spscQueue_t<sensorStreamSample_t, SENSOR_STREAM_BUFFER_SIZE> sensorStreamQueue;
+
+static volatile uint32_t sensorStreamChannels = 0;
+
+// Los escribe solo el hilo de alarma
+static uint32_t sensorStreamNextIndex = 0;
+static uint32_t sensorStreamDroppedCount = 0;
+
+// Muestra que no sigue a la anterior: abre la trama siguiente
+static sensorStreamSample_t sensorStreamPending;
+static bool sensorStreamPendingValid = false;
+
+static uint8_t sensorStreamFrame[SENSOR_STREAM_MAX_FRAME_SIZE];
+
+//=====[Declarations (prototypes) of private functions]========================
+
+static int sensorStreamSampleEncode( uint8_t* buffer, const sensorStreamSample_t* item,
+                                     uint32_t channels );
+static bool sensorStreamSampleRead( sensorStreamSample_t* item );
+static void sensorStreamLittleEndianWrite( uint8_t* buffer, uint32_t value, int length );
+
+//=====[Implementations of public functions]===================================
+
+void sensorStreamInit()
+{
+    spscQueueInit( &sensorStreamQueue );
+    sensorStreamChannels = 0;
+}
+
+// Una mascara 0 detiene el envio. El indice de muestra sigue contando entre
+// suscripciones, asi el receptor no confunde una con otra.
+void sensorStreamSubscribe( uint32_t channelMask )
+{
+    sensorStreamChannels = channelMask & SENSOR_STREAM_ALL_CHANNELS;
+}
+
+uint32_t sensorStreamSubscription()
+{
+    return sensorStreamChannels;
+}
+
+// Sin suscripcion no hace nada; con ella solo copia la muestra a la cola.
+void sensorStreamSampleWrite( uint16_t lm35, uint16_t potentiometer, bool mq2,
+                              uint16_t lm35Filtered )
+{
+    sensorStreamSample_t item;
+
+    if ( sensorStreamChannels == 0 ) {
+        return;
+    }
+
+    item.index = sensorStreamNextIndex++;
+    item.lm35 = lm35;
+    item.potentiometer = potentiometer;
+    item.mq2 = mq2;
+    item.lm35Filtered = lm35Filtered;
+    if ( !spscQueuePush( &sensorStreamQueue, item ) ) {
+        sensorStreamDroppedCount++;
+    }
+}
+
+// Envia tramas mientras haya muestras y lugar en el buffer de TX; si la UART
+// no da abasto la cola se llena y el productor descarta, nunca se bloquea.
+void sensorStreamUpdate()
+{
+    sensorStreamSample_t item;
+    uint32_t channels = sensorStreamChannels;
+    uint32_t firstSample = 0;
+    uint32_t crc;
+    int frameLength;
+    int count;
+
+    while ( pcSerialComTxFree() >= SENSOR_STREAM_MAX_FRAME_SIZE ) {
+        frameLength = SENSOR_STREAM_PREFIX_SIZE + SENSOR_STREAM_BODY_HEADER_SIZE;
+        count = 0;
+
+        while ( count < SENSOR_STREAM_MAX_SAMPLES_PER_FRAME &&
+                sensorStreamSampleRead( &item ) ) {
+            if ( channels == 0 ) {
+                continue;               // Encoladas antes de desuscribirse
+            }
+            if ( count == 0 ) {
+                firstSample = item.index;
+            } else if ( item.index != firstSample + count ) {
+                sensorStreamPending = item;
+                sensorStreamPendingValid = true;
+                break;
+            }
+            frameLength += sensorStreamSampleEncode( &sensorStreamFrame[frameLength],
+                                                     &item, channels );
+            count++;
+        }
+        if ( count == 0 ) {
+            return;
+        }
+
+        sensorStreamFrame[0] = SENSOR_STREAM_SYNC_0;
+        sensorStreamFrame[1] = SENSOR_STREAM_SYNC_1;
+        sensorStreamLittleEndianWrite( &sensorStreamFrame[2],
+                                       frameLength - SENSOR_STREAM_PREFIX_SIZE, 2 );
+        sensorStreamFrame[4] = SENSOR_STREAM_FRAME_SAMPLES;
+        sensorStreamFrame[5] = (uint8_t) channels;
+        sensorStreamFrame[6] = (uint8_t) count;
+        sensorStreamLittleEndianWrite( &sensorStreamFrame[7], firstSample, 4 );
+
+        sensorStreamCrc.compute( &sensorStreamFrame[2], frameLength - 2, &crc );
+        sensorStreamLittleEndianWrite( &sensorStreamFrame[frameLength], crc, 2 );
+        frameLength += SENSOR_STREAM_CRC_SIZE;
+
+        pcSerialComWrite( (const char*) sensorStreamFrame, frameLength );
+    }
+}
+
+uint32_t sensorStreamDroppedSamples()
+{
+    return sensorStreamDroppedCount;
+}
+
+//=====[Implementations of private functions]==================================
+
+static bool sensorStreamSampleRead( sensorStreamSample_t* item )
+{
+    if ( sensorStreamPendingValid ) {
+        *item = sensorStreamPending;
+        sensorStreamPendingValid = false;
+        return true;
+    }
+    return spscQueuePop( &sensorStreamQueue, item );
+}
+
+static int sensorStreamSampleEncode( uint8_t* buffer, const sensorStreamSample_t* item,
+                                     uint32_t channels )
+{
+    uint8_t* cursor = buffer;
+
+    if ( channels & SENSOR_STREAM_CHANNEL_MASK( SENSOR_STREAM_CHANNEL_LM35_RAW ) ) {
+        sensorStreamLittleEndianWrite( cursor, item->lm35, 2 );
+        cursor += 2;
+    }
+    if ( channels & SENSOR_STREAM_CHANNEL_MASK( SENSOR_STREAM_CHANNEL_POTENTIOMETER ) ) {
+        sensorStreamLittleEndianWrite( cursor, item->potentiometer, 2 );
+        cursor += 2;
+    }
+    if ( channels & SENSOR_STREAM_CHANNEL_MASK( SENSOR_STREAM_CHANNEL_MQ2 ) ) {
+        *cursor++ = item->mq2;
+    }
+    if ( channels & SENSOR_STREAM_CHANNEL_MASK( SENSOR_STREAM_CHANNEL_LM35_FILTERED ) ) {
+        sensorStreamLittleEndianWrite( cursor, item->lm35Filtered, 2 );
+        cursor += 2;
+    }
+    return cursor - buffer;
+}
+
+static void sensorStreamLittleEndianWrite( uint8_t* buffer, uint32_t value, int length )
+{
+    int i;
+
+    for ( i = 0; i < length; i++ ) {
+        buffer[i] = (uint8_t) ( value >> ( 8 * i ) );
+    }
+}
@@ -0,0 +1,45 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _SENSOR_STREAM_H_
+#define _SENSOR_STREAM_H_
+
+//=====[Libraries]=============================================================
+
+#include <stdint.h>
+
+//=====[Declaration of public defines]=========================================
+
+#define SENSOR_STREAM_BUFFER_SIZE             512   // Muestras, potencia de 2
+#define SENSOR_STREAM_MAX_SAMPLES_PER_FRAME    64
+
+#define SENSOR_STREAM_CHANNEL_MASK( channel )    ( 1UL << ( channel ) )
+
+//=====[Declaration of public data types]======================================
+
+// Orden de los campos dentro de cada muestra de una trama
+typedef enum {
+    SENSOR_STREAM_CHANNEL_LM35_RAW,         // u16, lectura cruda de A1
+    SENSOR_STREAM_CHANNEL_POTENTIOMETER,    // u16, lectura cruda de A0
+    SENSOR_STREAM_CHANNEL_MQ2,              // u8, nivel de la salida del MQ-2
+    SENSOR_STREAM_CHANNEL_LM35_FILTERED,    // u16, salida del promedio movil
+    SENSOR_STREAM_NUMBER_OF_CHANNELS,
+} sensorStreamChannel_t;
+
+//=====[Declarations (prototypes) of public functions]=========================
+
+void sensorStreamInit();
+void sensorStreamSubscribe( uint32_t channelMask );
+uint32_t sensorStreamSubscription();
+
+// Desde el hilo de alarma, una vez por muestra adquirida
+void sensorStreamSampleWrite( uint16_t lm35, uint16_t potentiometer, bool mq2,
+                              uint16_t lm35Filtered );
+
+// Desde el hilo de telemetria: arma y envia las tramas
+void sensorStreamUpdate();
+
+uint32_t sensorStreamDroppedSamples();
+
+//=====[#include guards - end]=================================================
+
+#endif // _SENSOR_STREAM_H_
@@ -0,0 +1,67 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _SEQLOCK_H_
+#define _SEQLOCK_H_
+
+//=====[Libraries]=============================================================
+
+#include "mbed.h"
+
+//=====[Declaration of public data types]======================================
+
+// Valor compartido sin locks entre un escritor y cualquier cantidad de
+// lectores. El escritor deja la secuencia impar mientras copia; el lector
+// repite la copia si la secuencia era impar o cambio mientras leia, asi que
+// nunca ve un valor mezclado. Ningun lector puede desalojar al escritor
+// (interrupciones o hilos de mayor prioridad): esperaria para siempre a
+// que termine la escritura que interrumpio.
+template <typename T>
+struct seqlock_t {
+    T value;
+    volatile uint32_t sequence;   // La escribe solo el escritor
+};
+
+//=====[Implementations of public functions]===================================
+
+// El valor arranca en cero hasta la primera escritura
+template <typename T>
+void seqlockInit( seqlock_t<T>* lock )
+{
+    lock->value = T();
+    lock->sequence = 0;
+}
+
+template <typename T>
+void seqlockWrite( seqlock_t<T>* lock, const T& value )
+{
+    uint32_t sequence = lock->sequence;
+
+    lock->sequence = sequence + 1;
+    __DMB();
+    lock->value = value;
+    __DMB();
+    lock->sequence = sequence + 2;
+}
+
+// Retorna cuantas veces hubo que repetir la copia, normalmente 0
+template <typename T>
+uint32_t seqlockRead( const seqlock_t<T>* lock, T* value )
+{
+    uint32_t sequence;
+    uint32_t retries = 0;
+
+    for ( ;; ) {
+        sequence = lock->sequence;
+        __DMB();
+        *value = lock->value;
+        __DMB();
+        if ( ( sequence & 1 ) == 0 && sequence == lock->sequence ) {
+            return retries;
+        }
+        retries++;
+    }
+}
+
+//=====[#include guards - end]=================================================
+
+#endif // _SEQLOCK_H_
@@ -0,0 +1,66 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _SPSC_QUEUE_H_
+#define _SPSC_QUEUE_H_
+
+//=====[Libraries]=============================================================
+
+#include "mbed.h"
+
+//=====[Declaration of public data types]======================================
+
+// Cola sin locks de un productor y un consumidor, para pasar datos entre
+// hilos (o entre una interrupcion y un hilo). Cada lado escribe solo su
+// propio indice; la barrera asegura que el dato quede escrito antes de
+// publicar el indice. size debe ser potencia de 2.
+template <typename T, uint32_t size>
+struct spscQueue_t {
+    static_assert( ( size & ( size - 1 ) ) == 0, "size debe ser potencia de 2" );
+
+    T items[size];
+    volatile uint32_t head;   // Lo escribe solo el productor
+    volatile uint32_t tail;   // Lo escribe solo el consumidor
+};
+
+//=====[Implementations of public functions]===================================
+
+template <typename T, uint32_t size>
+void spscQueueInit( spscQueue_t<T, size>* queue )
+{
+    queue->head = 0;
+    queue->tail = 0;
+}
+
+// Retorna false si la cola esta llena; el elemento no se encola.
+template <typename T, uint32_t size>
+bool spscQueuePush( spscQueue_t<T, size>* queue, const T& item )
+{
+    uint32_t head = queue->head;
+
+    if ( head - queue->tail >= size ) {
+        return false;
+    }
+    queue->items[head & ( size - 1 )] = item;
+    __DMB();
+    queue->head = head + 1;
+    return true;
+}
+
+template <typename T, uint32_t size>
+bool spscQueuePop( spscQueue_t<T, size>* queue, T* item )
+{
+    uint32_t tail = queue->tail;
+
+    if ( tail == queue->head ) {
+        return false;
+    }
+    __DMB();
+    *item = queue->items[tail & ( size - 1 )];
+    __DMB();
+    queue->tail = tail + 1;
+    return true;
+}
+
+//=====[#include guards - end]=================================================
+
+#endif // _SPSC_QUEUE_H_
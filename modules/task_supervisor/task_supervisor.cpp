@@ -0,0 +1,275 @@
+//=====[Libraries]=============================================================
+
+#include "mbed.h"
+#include "arm_book_lib.h"
+
+#include "task_supervisor.h"
+#include "scheduler.h"
+
+#include <stddef.h>
+#include <string.h>
+
+//=====[Declaration of private defines]========================================
+
+#define TASK_SUPERVISOR_BACKUP_MAGIC    0x53555056UL   // "SUPV"
+#define TASK_SUPERVISOR_NO_TASK         -1
+
+//=====[Declaration of private data types]=====================================
+
+typedef struct {
+    const char* name;
+    uint32_t deadlineMs;
+    bool critical;
+    volatile bool late;
+    volatile uint32_t lastCheckInMs;
+    uint32_t misses;
+} taskSupervisorTask_t;
+
+// Contenido de la RAM de backup. Se valida con magic y checksum porque al
+// encender la placa tiene basura; numberOfTasks descarta los contadores si
+// cambio la lista de tareas y sus indices ya no corresponden.
+typedef struct {
+    uint32_t magic;
+    uint32_t numberOfTasks;
+    uint32_t watchdogResets;
+    int32_t lastLateTask;       // Ultima tarea critica que freno al watchdog
+    uint32_t misses[TASK_SUPERVISOR_MAX_TASKS];
+    uint32_t checksum;
+} taskSupervisorBackup_t;
+
+//=====[Declaration and initialization of private global objects]==============
+
+#if MBED_CONF_APP_LOW_POWER_MODE
+static LowPowerTicker taskSupervisorTicker;
+#else
+static Ticker taskSupervisorTicker;
+#endif
+
+//=====[Declaration and initialization of private global variables]============
+
+// Los 4 KB de backup SRAM del F4 conservan su contenido en un reset, incluido
+// el del watchdog. En un target sin ella los contadores solo cuentan desde
+// el arranque.
+#if defined( BKPSRAM_BASE )
+static taskSupervisorBackup_t* const taskSupervisorBackup =
+    (taskSupervisorBackup_t*) BKPSRAM_BASE;
+#else
+static taskSupervisorBackup_t taskSupervisorBackupRam;
+static taskSupervisorBackup_t* const taskSupervisorBackup = &taskSupervisorBackupRam;
+#endif
+
+static taskSupervisorTask_t taskSupervisorTasks[TASK_SUPERVISOR_MAX_TASKS];
+static int taskSupervisorNumberOfTasksAdded = 0;
+static bool taskSupervisorWatchdogResetSeen = false;
+
+//=====[Declarations (prototypes) of private functions]========================
+
+static void taskSupervisorIsr();
+static void taskSupervisorBackupEnable();
+static void taskSupervisorBackupClear();
+static uint32_t taskSupervisorBackupChecksum();
+
+//=====[Implementations of public functions]===================================
+
+// Recupera los contadores de antes del reset y cuenta el reset si lo
+// provoco el watchdog
+void taskSupervisorInit()
+{
+    taskSupervisorBackupEnable();
+    if ( taskSupervisorBackup->magic != TASK_SUPERVISOR_BACKUP_MAGIC ||
+         taskSupervisorBackup->checksum != taskSupervisorBackupChecksum() ) {
+        taskSupervisorBackupClear();
+    }
+
+    taskSupervisorWatchdogResetSeen = ResetReason::get() == RESET_REASON_WATCHDOG;
+    if ( taskSupervisorWatchdogResetSeen ) {
+        taskSupervisorBackup->watchdogResets++;
+        taskSupervisorBackup->checksum = taskSupervisorBackupChecksum();
+    }
+
+    taskSupervisorNumberOfTasksAdded = 0;
+}
+
+// Retorna el indice para taskSupervisorCheckIn(), o -1 si no hay lugar
+int taskSupervisorTaskAdd( const char* name, uint32_t deadlineMs, bool critical )
+{
+    taskSupervisorTask_t* task;
+
+    if ( taskSupervisorNumberOfTasksAdded >= TASK_SUPERVISOR_MAX_TASKS ) {
+        return TASK_SUPERVISOR_NO_TASK;
+    }
+
+    task = &taskSupervisorTasks[taskSupervisorNumberOfTasksAdded];
+    task->name = name;
+    task->deadlineMs = deadlineMs;
+    task->critical = critical;
+    task->late = false;
+    task->lastCheckInMs = schedulerTimeMs();
+    task->misses = 0;
+
+    return taskSupervisorNumberOfTasksAdded++;
+}
+
+// Los plazos cuentan desde aca. Una vez arrancado, el watchdog no se puede
+// detener: solo lo alimenta la interrupcion mientras las tareas criticas
+// esten en plazo.
+void taskSupervisorStart()
+{
+    uint32_t nowMs = schedulerTimeMs();
+    int i;
+
+    if ( taskSupervisorBackup->numberOfTasks != (uint32_t) taskSupervisorNumberOfTasksAdded ) {
+        memset( taskSupervisorBackup->misses, 0, sizeof( taskSupervisorBackup->misses ) );
+        taskSupervisorBackup->numberOfTasks = taskSupervisorNumberOfTasksAdded;
+        taskSupervisorBackup->lastLateTask = TASK_SUPERVISOR_NO_TASK;
+        taskSupervisorBackup->checksum = taskSupervisorBackupChecksum();
+    }
+
+    for ( i = 0; i < taskSupervisorNumberOfTasksAdded; i++ ) {
+        taskSupervisorTasks[i].lastCheckInMs = nowMs;
+    }
+
+    taskSupervisorTicker.attach( &taskSupervisorIsr,
+                                 std::chrono::milliseconds( TASK_SUPERVISOR_PERIOD_MS ) );
+#if TASK_SUPERVISOR_WATCHDOG_TIMEOUT_MS > 0
+    Watchdog::get_instance().start( TASK_SUPERVISOR_WATCHDOG_TIMEOUT_MS );
+#endif
+}
+
+void taskSupervisorCheckIn( int task )
+{
+    if ( task < 0 || task >= taskSupervisorNumberOfTasksAdded ) {
+        return;
+    }
+    taskSupervisorTasks[task].lastCheckInMs = schedulerTimeMs();
+}
+
+int taskSupervisorNumberOfTasks()
+{
+    return taskSupervisorNumberOfTasksAdded;
+}
+
+bool taskSupervisorRead( int task, taskSupervisorStats_t* stats )
+{
+    if ( task < 0 || task >= taskSupervisorNumberOfTasksAdded ) {
+        return false;
+    }
+
+    stats->name = taskSupervisorTasks[task].name;
+    stats->deadlineMs = taskSupervisorTasks[task].deadlineMs;
+    stats->critical = taskSupervisorTasks[task].critical;
+    stats->late = taskSupervisorTasks[task].late;
+    stats->misses = taskSupervisorTasks[task].misses;
+    stats->totalMisses = taskSupervisorBackup->misses[task];
+    return true;
+}
+
+// El ultimo reset lo provoco el watchdog
+bool taskSupervisorWatchdogReset()
+{
+    return taskSupervisorWatchdogResetSeen;
+}
+
+uint32_t taskSupervisorWatchdogResets()
+{
+    return taskSupervisorBackup->watchdogResets;
+}
+
+// -1 si ninguna tarea critica se atraso desde el ultimo taskSupervisorReset()
+int taskSupervisorLastLateTask()
+{
+    return taskSupervisorBackup->lastLateTask;
+}
+
+// Borra los contadores de la RAM de backup y los del arranque
+void taskSupervisorReset()
+{
+    int i;
+
+    core_util_critical_section_enter();
+    taskSupervisorBackupClear();
+    taskSupervisorBackup->numberOfTasks = taskSupervisorNumberOfTasksAdded;
+    taskSupervisorBackup->checksum = taskSupervisorBackupChecksum();
+    for ( i = 0; i < taskSupervisorNumberOfTasksAdded; i++ ) {
+        taskSupervisorTasks[i].misses = 0;
+    }
+    core_util_critical_section_exit();
+}
+
+//=====[Implementations of private functions]==================================
+
+// Corre por timer y no en un hilo, asi ve atrasarse a cualquiera de ellos.
+// Cada atraso cuenta una sola vez, al vencer el plazo, aunque dure varias
+// revisiones.
+static void taskSupervisorIsr()
+{
+    uint32_t nowMs = schedulerTimeMs();
+    taskSupervisorTask_t* task;
+    bool onTime = true;
+    bool backupChanged = false;
+    bool late;
+    int i;
+
+    for ( i = 0; i < taskSupervisorNumberOfTasksAdded; i++ ) {
+        task = &taskSupervisorTasks[i];
+        late = nowMs - task->lastCheckInMs > task->deadlineMs;
+
+        if ( late && !task->late ) {
+            task->misses++;
+            taskSupervisorBackup->misses[i]++;
+            backupChanged = true;
+        }
+        task->late = late;
+
+        if ( late && task->critical ) {
+            if ( onTime && taskSupervisorBackup->lastLateTask != i ) {
+                taskSupervisorBackup->lastLateTask = i;
+                backupChanged = true;
+            }
+            onTime = false;
+        }
+    }
+
+    if ( backupChanged ) {
+        taskSupervisorBackup->checksum = taskSupervisorBackupChecksum();
+    }
+
+#if TASK_SUPERVISOR_WATCHDOG_TIMEOUT_MS > 0
+    if ( onTime ) {
+        Watchdog::get_instance().kick();
+    }
+#endif
+}
+
+// Reloj de la interfaz, acceso de escritura al dominio de backup y reloj
+// de la backup SRAM, como indica el manual de referencia del F429
+static void taskSupervisorBackupEnable()
+{
+#if defined( BKPSRAM_BASE )
+    __HAL_RCC_PWR_CLK_ENABLE();
+    HAL_PWR_EnableBkUpAccess();
+    __HAL_RCC_BKPSRAM_CLK_ENABLE();
+#endif
+}
+
+static void taskSupervisorBackupClear()
+{
+    memset( taskSupervisorBackup, 0, sizeof( *taskSupervisorBackup ) );
+    taskSupervisorBackup->magic = TASK_SUPERVISOR_BACKUP_MAGIC;
+    taskSupervisorBackup->lastLateTask = TASK_SUPERVISOR_NO_TASK;
+    taskSupervisorBackup->checksum = taskSupervisorBackupChecksum();
+}
+
+// Suma rotada de todas las palabras menos el checksum
+static uint32_t taskSupervisorBackupChecksum()
+{
+    const uint32_t* words = (const uint32_t*) taskSupervisorBackup;
+    uint32_t checksum = 0;
+    size_t i;
+
+    for ( i = 0; i < offsetof( taskSupervisorBackup_t, checksum ) / sizeof( uint32_t ); i++ ) {
+        checksum = ( ( checksum << 5 ) | ( checksum >> 27 ) ) + words[i];
+    }
+
+    return ~checksum;
+}
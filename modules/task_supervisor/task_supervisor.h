@@ -0,0 +1,51 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _TASK_SUPERVISOR_H_
+#define _TASK_SUPERVISOR_H_
+
+//=====[Libraries]=============================================================
+
+#include <stdint.h>
+
+//=====[Declaration of public defines]=========================================
+
+#ifdef MBED_CONF_APP_WATCHDOG_TIMEOUT_MS
+#define TASK_SUPERVISOR_WATCHDOG_TIMEOUT_MS    MBED_CONF_APP_WATCHDOG_TIMEOUT_MS
+#else
+#define TASK_SUPERVISOR_WATCHDOG_TIMEOUT_MS    2000   // 0 deja el watchdog apagado
+#endif
+#define TASK_SUPERVISOR_MAX_TASKS                 8
+#define TASK_SUPERVISOR_PERIOD_MS                20   // Revision de los plazos
+
+//=====[Declaration of public data types]======================================
+
+typedef struct {
+    const char* name;
+    uint32_t deadlineMs;        // Maximo entre dos taskSupervisorCheckIn()
+    bool critical;              // Si se atrasa deja de alimentarse el watchdog
+    bool late;
+    uint32_t misses;            // Plazos perdidos desde el arranque
+    uint32_t totalMisses;       // Acumulado en la RAM de backup, sobrevive al reset
+} taskSupervisorStats_t;
+
+//=====[Declarations (prototypes) of public functions]=========================
+
+// Init al arrancar, antes de registrar las tareas; Start recien cuando
+// todas estan registradas y el scheduler por correr
+void taskSupervisorInit();
+int taskSupervisorTaskAdd( const char* name, uint32_t deadlineMs, bool critical );
+void taskSupervisorStart();
+
+// Desde la tarea supervisada, en cada ejecucion
+void taskSupervisorCheckIn( int task );
+
+int taskSupervisorNumberOfTasks();
+bool taskSupervisorRead( int task, taskSupervisorStats_t* stats );
+bool taskSupervisorWatchdogReset();
+uint32_t taskSupervisorWatchdogResets();
+int taskSupervisorLastLateTask();
+void taskSupervisorReset();
+
+//=====[#include guards - end]=================================================
+
+#endif // _TASK_SUPERVISOR_H_
@@ -0,0 +1,186 @@
+//=====[Libraries]=============================================================
+
+#include "mbed.h"
+#include "arm_book_lib.h"
+
+#include "task_timing.h"
+
+//=====[Declaration of private defines]========================================
+
+#define TASK_TIMING_US_PER_S    1000000
+
+//=====[Declaration of private data types]=====================================
+
+// Los tiempos se acumulan en ciclos y se pasan a microsegundos al leerlos
+typedef struct {
+    const char* name;
+    uint32_t budgetCycles;
+    uint32_t count;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint64_t totalCycles;
+    uint32_t overruns;
+    uint32_t histogram[TASK_TIMING_HISTOGRAM_BUCKETS];
+} taskTimingProbe_t;
+
+//=====[Declaration and initialization of private global variables]============
+
+static taskTimingProbe_t taskTimingProbes[TASK_TIMING_MAX_PROBES];
+static int taskTimingProbesUsed = 0;
+
+static uint32_t taskTimingCyclesPerUs = 1;
+
+// Limites superiores de cada cubeta del histograma, en microsegundos
+static const uint32_t taskTimingBucketLimitsUs[TASK_TIMING_HISTOGRAM_BUCKETS - 1] = {
+    10, 100, 1000, 10000, 100000
+};
+
+//=====[Declarations (prototypes) of private functions]========================
+
+static int taskTimingBucket( uint32_t elapsedUs );
+static void taskTimingProbeClear( taskTimingProbe_t* probe );
+
+//=====[Implementations of public functions]===================================
+
+// Usa el contador de ciclos DWT del Cortex-M4: leerlo cuesta un acceso a
+// memoria, asi que las sondas pueden quedar siempre activas.
+void taskTimingInit()
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    taskTimingCyclesPerUs = SystemCoreClock / TASK_TIMING_US_PER_S;
+    taskTimingProbesUsed = 0;
+}
+
+int taskTimingProbeAdd( const char* name, uint32_t budgetUs )
+{
+    if ( taskTimingProbesUsed >= TASK_TIMING_MAX_PROBES ) {
+        return -1;
+    }
+
+    taskTimingProbe_t* probe = &taskTimingProbes[taskTimingProbesUsed];
+    probe->name = name;
+    probe->budgetCycles = budgetUs * taskTimingCyclesPerUs;
+    taskTimingProbeClear( probe );
+
+    return taskTimingProbesUsed++;
+}
+
+uint32_t taskTimingStart()
+{
+    return DWT->CYCCNT;
+}
+
+// Cada sonda se actualiza desde un unico hilo. A 180 MHz el contador da la
+// vuelta cada 23 s, mas que cualquier tarea.
+void taskTimingStop( int probe, uint32_t startCycles )
+{
+    uint32_t elapsedCycles = DWT->CYCCNT - startCycles;
+
+    if ( probe < 0 || probe >= taskTimingProbesUsed ) {
+        return;
+    }
+
+    taskTimingProbe_t* p = &taskTimingProbes[probe];
+
+    core_util_critical_section_enter();
+    p->count++;
+    p->totalCycles += elapsedCycles;
+    if ( elapsedCycles < p->minCycles ) {
+        p->minCycles = elapsedCycles;
+    }
+    if ( elapsedCycles > p->maxCycles ) {
+        p->maxCycles = elapsedCycles;
+    }
+    if ( elapsedCycles > p->budgetCycles ) {
+        p->overruns++;
+    }
+    p->histogram[taskTimingBucket( elapsedCycles / taskTimingCyclesPerUs )]++;
+    core_util_critical_section_exit();
+}
+
+// Para los modulos que guardan sus propias marcas de taskTimingStart()
+uint32_t taskTimingCyclesToUs( uint32_t cycles )
+{
+    return cycles / taskTimingCyclesPerUs;
+}
+
+int taskTimingNumberOfProbes()
+{
+    return taskTimingProbesUsed;
+}
+
+// Copia la sonda en una seccion critica para no mezclar valores de dos
+// ejecuciones distintas.
+bool taskTimingRead( int probe, taskTimingStats_t* stats )
+{
+    taskTimingProbe_t copy;
+    int i;
+
+    if ( probe < 0 || probe >= taskTimingProbesUsed ) {
+        return false;
+    }
+
+    core_util_critical_section_enter();
+    copy = taskTimingProbes[probe];
+    core_util_critical_section_exit();
+
+    stats->name     = copy.name;
+    stats->budgetUs = copy.budgetCycles / taskTimingCyclesPerUs;
+    stats->count    = copy.count;
+    stats->overruns = copy.overruns;
+    if ( copy.count > 0 ) {
+        stats->minUs = copy.minCycles / taskTimingCyclesPerUs;
+        stats->avgUs = (uint32_t) ( copy.totalCycles / copy.count / taskTimingCyclesPerUs );
+        stats->maxUs = copy.maxCycles / taskTimingCyclesPerUs;
+    } else {
+        stats->minUs = 0;
+        stats->avgUs = 0;
+        stats->maxUs = 0;
+    }
+    for ( i = 0; i < TASK_TIMING_HISTOGRAM_BUCKETS; i++ ) {
+        stats->histogram[i] = copy.histogram[i];
+    }
+
+    return true;
+}
+
+void taskTimingReset()
+{
+    int i;
+
+    for ( i = 0; i < taskTimingProbesUsed; i++ ) {
+        core_util_critical_section_enter();
+        taskTimingProbeClear( &taskTimingProbes[i] );
+        core_util_critical_section_exit();
+    }
+}
+
+//=====[Implementations of private functions]==================================
+
+static int taskTimingBucket( uint32_t elapsedUs )
+{
+    int bucket = 0;
+
+    while ( bucket < TASK_TIMING_HISTOGRAM_BUCKETS - 1 &&
+            elapsedUs >= taskTimingBucketLimitsUs[bucket] ) {
+        bucket++;
+    }
+    return bucket;
+}
+
+static void taskTimingProbeClear( taskTimingProbe_t* probe )
+{
+    int i;
+
+    probe->count       = 0;
+    probe->minCycles   = UINT32_MAX;
+    probe->maxCycles   = 0;
+    probe->totalCycles = 0;
+    probe->overruns    = 0;
+    for ( i = 0; i < TASK_TIMING_HISTOGRAM_BUCKETS; i++ ) {
+        probe->histogram[i] = 0;
+    }
+}
@@ -0,0 +1,43 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _TASK_TIMING_H_
+#define _TASK_TIMING_H_
+
+//=====[Libraries]=============================================================
+
+#include <stdint.h>
+
+//=====[Declaration of public defines]=========================================
+
+#define TASK_TIMING_MAX_PROBES          16
+#define TASK_TIMING_HISTOGRAM_BUCKETS    6   // <10us <100us <1ms <10ms <100ms resto
+
+//=====[Declaration of public data types]======================================
+
+typedef struct {
+    const char* name;
+    uint32_t budgetUs;          // Una ejecucion mas larga cuenta como overrun
+    uint32_t count;
+    uint32_t minUs;
+    uint32_t avgUs;
+    uint32_t maxUs;             // Peor tiempo de ejecucion observado
+    uint32_t overruns;
+    uint32_t histogram[TASK_TIMING_HISTOGRAM_BUCKETS];
+} taskTimingStats_t;
+
+//=====[Declarations (prototypes) of public functions]=========================
+
+void taskTimingInit();
+int taskTimingProbeAdd( const char* name, uint32_t budgetUs );
+
+uint32_t taskTimingStart();
+void taskTimingStop( int probe, uint32_t startCycles );
+uint32_t taskTimingCyclesToUs( uint32_t cycles );
+
+int taskTimingNumberOfProbes();
+bool taskTimingRead( int probe, taskTimingStats_t* stats );
+void taskTimingReset();
+
+//=====[#include guards - end]=================================================
+
+#endif // _TASK_TIMING_H_
@@ -0,0 +1,99 @@
+//=====[Libraries]=============================================================
+
+#include "mbed.h"
+#include "arm_book_lib.h"
+
+#include "telemetry.h"
+#include "scheduler.h"
+#include "pc_serial_com.h"
+
+//=====[Declaration of private defines]========================================
+
+#define TELEMETRY_FRAME_LENGTH    10   // "S:XXXXXX\r\n"
+
+//=====[Declaration and initialization of private global variables]============
+
+static telemetryLevel_t telemetryLevel = TELEMETRY_LEVEL_CHANGES;
+static int telemetryPeriodMs = TELEMETRY_DEFAULT_PERIOD_MS;
+
+static uint32_t telemetryLastStatusWord = 0;
+static uint32_t telemetryLastFrameTimeMs = 0;
+static bool telemetryStatusSent = false;
+
+//=====[Declarations (prototypes) of private functions]========================
+
+static void telemetryFrameSend( uint32_t statusWord );
+
+//=====[Implementations of public functions]===================================
+
+void telemetryInit( int periodMs )
+{
+    telemetryPeriodMs = periodMs;
+    telemetryStatusSent = false;
+}
+
+// Se llama en cada tick pero solo transmite cuando el estado cambio (como
+// mucho una trama cada TELEMETRY_MIN_INTERVAL_MS) o, en modo periodico,
+// cuando vence telemetryPeriodMs.
+void telemetryUpdate( uint32_t statusWord )
+{
+    uint32_t currentTimeMs = schedulerTimeMs();
+    uint32_t elapsedTimeMs = currentTimeMs - telemetryLastFrameTimeMs;
+    bool statusChanged = !telemetryStatusSent ||
+                         statusWord != telemetryLastStatusWord;
+
+    switch ( telemetryLevel ) {
+    case TELEMETRY_LEVEL_CHANGES:
+        if ( !statusChanged || elapsedTimeMs < TELEMETRY_MIN_INTERVAL_MS ) {
+            return;
+        }
+        break;
+
+    case TELEMETRY_LEVEL_PERIODIC:
+        if ( !( statusChanged && elapsedTimeMs >= TELEMETRY_MIN_INTERVAL_MS ) &&
+             elapsedTimeMs < (uint32_t) telemetryPeriodMs ) {
+            return;
+        }
+        break;
+
+    case TELEMETRY_LEVEL_OFF:
+    default:
+        return;
+    }
+
+    telemetryFrameSend( statusWord );
+    telemetryLastStatusWord = statusWord;
+    telemetryLastFrameTimeMs = currentTimeMs;
+    telemetryStatusSent = true;
+}
+
+void telemetryLevelWrite( telemetryLevel_t level )
+{
+    telemetryLevel = level;
+    telemetryStatusSent = false;   // Reenviar el estado actual con el nuevo nivel
+}
+
+telemetryLevel_t telemetryLevelRead()
+{
+    return telemetryLevel;
+}
+
+//=====[Implementations of private functions]==================================
+
+// Trama de ancho fijo: 'S', ':', 24 bits del estado en hexadecimal y CRLF.
+static void telemetryFrameSend( uint32_t statusWord )
+{
+    static const char hexDigits[] = "0123456789ABCDEF";
+    char frame[TELEMETRY_FRAME_LENGTH];
+    int i;
+
+    frame[0] = 'S';
+    frame[1] = ':';
+    for ( i = 0; i < 6; i++ ) {
+        frame[2 + i] = hexDigits[( statusWord >> ( 20 - 4 * i ) ) & 0xF];
+    }
+    frame[8] = '\r';
+    frame[9] = '\n';
+
+    pcSerialComWrite( frame, TELEMETRY_FRAME_LENGTH );
+}
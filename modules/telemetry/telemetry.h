@@ -0,0 +1,34 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _TELEMETRY_H_
+#define _TELEMETRY_H_
+
+//=====[Libraries]=============================================================
+
+#include <stdint.h>
+
+//=====[Declaration of public defines]=========================================
+
+#define TELEMETRY_DEFAULT_PERIOD_MS        1000
+#define TELEMETRY_MIN_INTERVAL_MS            50   // Limite de tramas por cambios
+
+//=====[Declaration of public data types]======================================
+
+typedef enum {
+    TELEMETRY_LEVEL_OFF,        // No se envia nada
+    TELEMETRY_LEVEL_CHANGES,    // Solo cuando cambia el estado
+    TELEMETRY_LEVEL_PERIODIC,   // Ante cambios y ademas cada periodo
+    TELEMETRY_NUMBER_OF_LEVELS,
+} telemetryLevel_t;
+
+//=====[Declarations (prototypes) of public functions]=========================
+
+void telemetryInit( int periodMs );
+void telemetryUpdate( uint32_t statusWord );
+
+void telemetryLevelWrite( telemetryLevel_t level );
+telemetryLevel_t telemetryLevelRead();
+
+//=====[#include guards - end]=================================================
+
+#endif // _TELEMETRY_H_
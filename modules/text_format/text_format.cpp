@@ -0,0 +1,77 @@
+//=====[Libraries]=============================================================
+
+#include "text_format.h"
+
+//=====[Declaration and initialization of private global variables]============
+
+static const char textFormatHexDigits[] = "0123456789ABCDEF";
+
+//=====[Implementations of public functions]===================================
+
+// Los digitos salen del menos significativo al mas significativo, asi que
+// se invierten al final en el mismo buffer.
+int textFormatUnsigned( char* buffer, uint32_t value )
+{
+    int length = 0;
+    int i;
+    char digit;
+
+    do {
+        buffer[length++] = (char) ( '0' + value % 10 );
+        value /= 10;
+    } while ( value != 0 );
+
+    for ( i = 0; i < length / 2; i++ ) {
+        digit = buffer[i];
+        buffer[i] = buffer[length - 1 - i];
+        buffer[length - 1 - i] = digit;
+    }
+    buffer[length] = '\0';
+
+    return length;
+}
+
+int textFormatSigned( char* buffer, int32_t value )
+{
+    if ( value < 0 ) {
+        buffer[0] = '-';
+        return 1 + textFormatUnsigned( &buffer[1], 0U - (uint32_t) value );
+    }
+    return textFormatUnsigned( buffer, (uint32_t) value );
+}
+
+// Punto fijo con dos decimales: 2575 -> "25.75", -5 -> "-0.05"
+int textFormatCentesimal( char* buffer, int32_t centesimalValue )
+{
+    uint32_t magnitude = centesimalValue < 0 ? 0U - (uint32_t) centesimalValue :
+                                               (uint32_t) centesimalValue;
+    int length = 0;
+
+    if ( centesimalValue < 0 ) {
+        buffer[length++] = '-';
+    }
+    length += textFormatUnsigned( &buffer[length], magnitude / 100 );
+    buffer[length++] = '.';
+    buffer[length++] = (char) ( '0' + magnitude % 100 / 10 );
+    buffer[length++] = (char) ( '0' + magnitude % 10 );
+    buffer[length] = '\0';
+
+    return length;
+}
+
+// Siempre digits caracteres (como mucho 8), con ceros a la izquierda
+int textFormatHex( char* buffer, uint32_t value, int digits )
+{
+    int i;
+
+    if ( digits > 8 ) {
+        digits = 8;
+    }
+    for ( i = digits - 1; i >= 0; i-- ) {
+        buffer[i] = textFormatHexDigits[value & 0xF];
+        value >>= 4;
+    }
+    buffer[digits] = '\0';
+
+    return digits;
+}
@@ -0,0 +1,26 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _TEXT_FORMAT_H_
+#define _TEXT_FORMAT_H_
+
+//=====[Libraries]=============================================================
+
+#include <stdint.h>
+
+//=====[Declaration of public defines]=========================================
+
+#define TEXT_FORMAT_NUMBER_MAX_LENGTH    13   // "-21474836.48" y el terminador
+
+//=====[Declarations (prototypes) of public functions]=========================
+
+// Escriben el numero en buffer, de al menos TEXT_FORMAT_NUMBER_MAX_LENGTH
+// bytes, con terminador, y retornan la cantidad de caracteres. No usan
+// printf ni memoria dinamica.
+int textFormatUnsigned( char* buffer, uint32_t value );
+int textFormatSigned( char* buffer, int32_t value );
+int textFormatCentesimal( char* buffer, int32_t centesimalValue );
+int textFormatHex( char* buffer, uint32_t value, int digits );
+
+//=====[#include guards - end]=================================================
+
+#endif // _TEXT_FORMAT_H_
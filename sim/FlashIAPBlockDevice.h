@@ -0,0 +1,24 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _SIM_FLASH_IAP_BLOCK_DEVICE_H_
+#define _SIM_FLASH_IAP_BLOCK_DEVICE_H_
+
+// Reemplazo de FlashIAPBlockDevice.h: solo guarda la zona asignada, el
+// TDBStore del simulador no la usa
+
+//=====[Libraries]=============================================================
+
+#include "mbed.h"
+
+//=====[Declaration of public data types]======================================
+
+class FlashIAPBlockDevice {
+public:
+    FlashIAPBlockDevice( uint32_t address, uint32_t size ) : address( address ), size( size ) {}
+    uint32_t address;
+    uint32_t size;
+};
+
+//=====[#include guards - end]=================================================
+
+#endif // _SIM_FLASH_IAP_BLOCK_DEVICE_H_
@@ -0,0 +1,57 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _SIM_TDB_STORE_H_
+#define _SIM_TDB_STORE_H_
+
+// Reemplazo de TDBStore.h con las claves en memoria: la configuracion dura
+// lo que dura una corrida del simulador.
+
+//=====[Libraries]=============================================================
+
+#include "mbed.h"
+#include "FlashIAPBlockDevice.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+//=====[Declaration of public defines]=========================================
+
+#define MBED_ERROR_ITEM_NOT_FOUND    ( -1 )
+#define MBED_ERROR_INVALID_SIZE      ( -2 )
+
+//=====[Declaration of public data types]======================================
+
+class TDBStore {
+public:
+    explicit TDBStore( FlashIAPBlockDevice* blockDevice ) {}
+    int init() { return MBED_SUCCESS; }
+    int set( const char* key, const void* buffer, size_t size, uint32_t createFlags )
+    {
+        const uint8_t* bytes = (const uint8_t*) buffer;
+        values[key].assign( bytes, bytes + size );
+        setCount++;
+        return MBED_SUCCESS;
+    }
+    int get( const char* key, void* buffer, size_t bufferSize,
+             size_t* actualSize = NULL, size_t offset = 0 )
+    {
+        std::map<std::string, std::vector<uint8_t> >::const_iterator value = values.find( key );
+        if ( value == values.end() ) {
+            return MBED_ERROR_ITEM_NOT_FOUND;
+        }
+        size_t size = value->second.size() < bufferSize ? value->second.size() : bufferSize;
+        memcpy( buffer, value->second.data(), size );
+        if ( actualSize != NULL ) {
+            *actualSize = size;
+        }
+        return MBED_SUCCESS;
+    }
+    int setCount = 0;       // Grabaciones, para ver que se agrupan
+private:
+    std::map<std::string, std::vector<uint8_t> > values;
+};
+
+//=====[#include guards - end]=================================================
+
+#endif // _SIM_TDB_STORE_H_
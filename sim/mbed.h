@@ -0,0 +1,576 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _SIM_MBED_H_
+#define _SIM_MBED_H_
+
+// Reemplazo de mbed.h para compilar el firmware en la PC. Implementa solo la
+// parte de la API de mbed-os 6 que usan los modulos, sobre el reloj virtual
+// de sim_core: los Ticker, Timeout y EventQueue son eventos en una unica
+// linea de tiempo y los hilos no existen, todo corre en orden de llegada.
+
+//=====[Libraries]=============================================================
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <functional>
+
+#include "sim_core.h"
+
+//=====[Declaration of public defines]=========================================
+
+#define EVENTS_EVENT_SIZE    32
+#define MBED_SUCCESS          0
+
+// Memoria del NUCLEO_F429ZI, como las define la compilacion de mbed-os
+#define MBED_ROM_START       0x08000000
+#define MBED_ROM_SIZE        0x200000
+
+//=====[Declaration of public data types]======================================
+
+typedef enum { PullNone, PullUp, PullDown, OpenDrain } PinMode;
+
+typedef enum {
+    osPriorityLow, osPriorityBelowNormal, osPriorityNormal,
+    osPriorityAboveNormal, osPriorityHigh, osPriorityRealtime,
+} osPriority;
+
+typedef void* osThreadId_t;
+typedef int osStatus_t;
+
+typedef struct {
+    uint64_t uptime;
+    uint64_t idle_time;
+    uint64_t sleep_time;
+    uint64_t deep_sleep_time;
+} mbed_stats_cpu_t;
+
+typedef struct {
+    PinName pin;
+} analogin_t;
+
+typedef struct {
+    PinName pin;
+} gpio_t;
+
+typedef enum {
+    IRQ_NONE,
+    IRQ_RISE,
+    IRQ_FALL,
+} gpio_irq_event;
+
+typedef void (*gpio_irq_handler)( uintptr_t context, gpio_irq_event event );
+
+typedef struct {
+    PinName pin;
+    gpio_irq_handler handler;
+    uintptr_t context;
+} gpio_irq_t;
+
+extern uint32_t SystemCoreClock;
+
+namespace mbed {
+
+template <typename Signature> class Callback;
+
+template <typename R, typename... Args>
+class Callback<R( Args... )> : public std::function<R( Args... )> {
+public:
+    Callback() {}
+    Callback( std::nullptr_t ) {}
+    template <typename F> Callback( F f ) : std::function<R( Args... )>( f ) {}
+
+    // Sin esto, pasar un Callback vacio donde se espera un std::function lo
+    // envuelve en uno no vacio
+    const std::function<R( Args... )>& function() const { return *this; }
+};
+
+inline Callback<void()> callback( void (*function)() )
+{
+    return Callback<void()>( function );
+}
+
+template <typename T>
+Callback<void()> callback( void (*function)( T* ), T* argument )
+{
+    return Callback<void()>( [=]() { function( argument ); } );
+}
+
+template <typename T, typename U>
+Callback<void()> callback( U* object, void (T::*method)() )
+{
+    return Callback<void()>( [=]() { ( object->*method )(); } );
+}
+
+template <typename Rep, typename Period>
+uint64_t simDurationUs( std::chrono::duration<Rep, Period> duration )
+{
+    return (uint64_t) std::chrono::duration_cast<std::chrono::microseconds>( duration ).count();
+}
+
+class DigitalOut {
+public:
+    DigitalOut( PinName pin, int value = 0 ) : pin( pin ) { write( value ); }
+    void write( int value ) { simPinWrite( pin, value ); }
+    int read() { return simPinRead( pin ); }
+    DigitalOut& operator=( int value ) { write( value ); return *this; }
+    operator int() { return read(); }
+private:
+    PinName pin;
+};
+
+// Open drain con pull-up externo: el pin queda en alto salvo que se lo
+// maneje como salida en bajo.
+class DigitalInOut {
+public:
+    DigitalInOut( PinName pin ) : pin( pin ), isOutput( false ), level( 1 ) {}
+    void mode( PinMode ) {}
+    void output() { isOutput = true; refresh(); }
+    void input() { isOutput = false; refresh(); }
+    void write( int value ) { level = value; refresh(); }
+    int read() { return simPinRead( pin ); }
+    DigitalInOut& operator=( int value ) { write( value ); return *this; }
+    operator int() { return read(); }
+private:
+    void refresh() { simPinWrite( pin, isOutput ? level : 1 ); }
+    PinName pin;
+    bool isOutput;
+    int level;
+};
+
+class InterruptIn {
+public:
+    InterruptIn( PinName pin ) : pin( pin ) {}
+    InterruptIn( PinName pin, PinMode ) : pin( pin ) {}
+    void rise( Callback<void()> handler ) { simPinEdgeHandlerSet( pin, true, handler.function() ); }
+    void fall( Callback<void()> handler ) { simPinEdgeHandlerSet( pin, false, handler.function() ); }
+    void mode( PinMode ) {}
+    int read() { return simPinRead( pin ); }
+    operator int() { return read(); }
+private:
+    PinName pin;
+};
+
+class Ticker {
+public:
+    Ticker() : timer( -1 ) {}
+    template <typename F, typename Rep, typename Period>
+    void attach( F handler, std::chrono::duration<Rep, Period> interval )
+    {
+        uint64_t intervalUs = simDurationUs( interval );
+        detach();
+        timer = simTimerAdd( intervalUs, intervalUs, Callback<void()>( handler ).function() );
+    }
+    void detach() { simTimerCancel( timer ); timer = -1; }
+private:
+    int timer;
+};
+
+class LowPowerTicker : public Ticker {};
+
+class Timeout {
+public:
+    Timeout() : timer( -1 ) {}
+    template <typename F, typename Rep, typename Period>
+    void attach( F handler, std::chrono::duration<Rep, Period> delay )
+    {
+        detach();
+        timer = simTimerAdd( simDurationUs( delay ), 0, Callback<void()>( handler ).function() );
+    }
+    void detach() { simTimerCancel( timer ); timer = -1; }
+private:
+    int timer;
+};
+
+class SerialBase {
+public:
+    enum IrqType { RxIrq = 0, TxIrq };
+};
+
+class UnbufferedSerial : public SerialBase {
+public:
+    UnbufferedSerial( PinName, PinName, int ) {}
+    ssize_t read( void* buffer, size_t length )
+    {
+        size_t i;
+        for ( i = 0; i < length && simUartRxRead( (char*) buffer + i ); i++ ) {
+        }
+        return (ssize_t) i;
+    }
+    ssize_t write( const void* buffer, size_t length )
+    {
+        for ( size_t i = 0; i < length; i++ ) {
+            simUartTxWrite( ( (const char*) buffer )[i] );
+        }
+        return (ssize_t) length;
+    }
+    bool readable();
+    bool writable() { return true; }
+    void attach( Callback<void()> handler, IrqType type = RxIrq )
+    {
+        if ( type == RxIrq ) {
+            simUartRxHandlerSet( handler.function() );
+        } else {
+            simUartTxHandlerSet( handler.function() );
+        }
+    }
+    void attach( std::nullptr_t, IrqType type = RxIrq ) { attach( Callback<void()>(), type ); }
+};
+
+class Watchdog {
+public:
+    static Watchdog& get_instance()
+    {
+        static Watchdog instance;
+        return instance;
+    }
+    bool start( uint32_t timeoutMs ) { simWatchdogStart( timeoutMs ); return true; }
+    bool kick() { simWatchdogKick(); return true; }
+};
+
+// La simulacion siempre arranca como tras encender la placa
+typedef enum {
+    RESET_REASON_POWER_ON,
+    RESET_REASON_WATCHDOG,
+    RESET_REASON_SOFTWARE,
+    RESET_REASON_UNKNOWN,
+} reset_reason_t;
+
+class ResetReason {
+public:
+    static reset_reason_t get() { return RESET_REASON_POWER_ON; }
+};
+
+// Pila de red minima para la telemetria UDP: una unica interfaz que se
+// conecta sola despues de un rato y un socket que entrega todo
+typedef int nsapi_error_t;
+typedef int nsapi_size_or_error_t;
+
+#define NSAPI_ERROR_OK                 0
+#define NSAPI_ERROR_WOULD_BLOCK    -3001
+#define NSAPI_ERROR_NO_SOCKET      -3005
+#define NSAPI_ERROR_IN_PROGRESS    -3013
+#define NSAPI_ERROR_BUSY           -3014
+#define NSAPI_ERROR_IS_CONNECTED   -3015
+
+typedef enum {
+    NSAPI_STATUS_LOCAL_UP,
+    NSAPI_STATUS_GLOBAL_UP,
+    NSAPI_STATUS_DISCONNECTED,
+    NSAPI_STATUS_CONNECTING,
+    NSAPI_STATUS_ERROR_UNSUPPORTED,
+} nsapi_connection_status_t;
+
+class SocketAddress {
+public:
+    bool set_ip_address( const char* address ) { return address != NULL && address[0] != '\0'; }
+    void set_port( uint16_t port ) {}
+};
+
+class NetworkInterface {
+public:
+    static NetworkInterface* get_default_instance()
+    {
+        static NetworkInterface instance;
+        return &instance;
+    }
+    void set_blocking( bool blocking ) {}
+    nsapi_error_t connect() { simNetworkConnect(); return NSAPI_ERROR_OK; }
+    nsapi_error_t disconnect() { simNetworkDisconnect(); return NSAPI_ERROR_OK; }
+    nsapi_connection_status_t get_connection_status()
+    {
+        return simNetworkUp() ? NSAPI_STATUS_GLOBAL_UP : NSAPI_STATUS_CONNECTING;
+    }
+};
+
+class UDPSocket {
+public:
+    nsapi_error_t open( NetworkInterface* interface ) { isOpen = true; return NSAPI_ERROR_OK; }
+    nsapi_error_t close() { isOpen = false; return NSAPI_ERROR_OK; }
+    void set_blocking( bool blocking ) {}
+    nsapi_size_or_error_t sendto( const SocketAddress& address, const void* data, uint32_t size )
+    {
+        if ( !isOpen || !simNetworkUp() ) {
+            return NSAPI_ERROR_NO_SOCKET;
+        }
+        simNetworkDatagramWrite( data, size );
+        return size;
+    }
+private:
+    bool isOpen = false;
+};
+
+// Flash de 2 MB con la geometria del STM32F429: por banco, 4 sectores de
+// 16 KB, 1 de 64 KB y 7 de 128 KB. Como en el chip, programar solo baja bits.
+class FlashIAP {
+public:
+    int init() { return 0; }
+    int deinit() { return 0; }
+    int read( void* buffer, uint32_t address, uint32_t size )
+    {
+        if ( !valid( address, size ) ) {
+            return -1;
+        }
+        memcpy( buffer, simFlashMemory() + ( address - flashStart ), size );
+        return 0;
+    }
+    int program( const void* buffer, uint32_t address, uint32_t size )
+    {
+        if ( !valid( address, size ) ) {
+            return -1;
+        }
+        for ( uint32_t i = 0; i < size; i++ ) {
+            simFlashMemory()[address - flashStart + i] &= ( (const uint8_t*) buffer )[i];
+        }
+        return 0;
+    }
+    int erase( uint32_t address, uint32_t size )
+    {
+        if ( !valid( address, size ) ) {
+            return -1;
+        }
+        memset( simFlashMemory() + ( address - flashStart ), 0xFF, size );
+        return 0;
+    }
+    uint32_t get_page_size() const { return 1; }
+    uint32_t get_sector_size( uint32_t address ) const
+    {
+        uint32_t offset = ( address - flashStart ) % ( flashSize / 2 );
+        if ( offset < 0x10000 ) {
+            return 0x4000;
+        }
+        return offset < 0x20000 ? 0x10000 : 0x20000;
+    }
+    uint32_t get_flash_start() const { return flashStart; }
+    uint32_t get_flash_size() const { return flashSize; }
+    uint8_t get_erase_value() const { return 0xFF; }
+private:
+    static const uint32_t flashStart = 0x08000000;
+    static const uint32_t flashSize  = 0x200000;
+    bool valid( uint32_t address, uint32_t size ) const
+    {
+        return address >= flashStart && address - flashStart + size <= flashSize;
+    }
+};
+
+typedef enum {
+    POLY_16BIT_CCITT = 0x1021,
+    POLY_32BIT_ANSI  = 0x04C11DB7,
+} crc_polynomial_t;
+
+// Solo la variante CCITT de 16 bits: valor inicial 0xFFFF, sin reflejar y
+// sin XOR final, como los valores por defecto de mbed
+template <uint32_t polynomial, int width>
+class MbedCRC {
+    static_assert( polynomial == POLY_16BIT_CCITT && width == 16,
+                   "El simulador solo implementa CRC-16 CCITT" );
+public:
+    int compute( const void* buffer, unsigned long size, uint32_t* crc )
+    {
+        uint16_t value = 0xFFFF;
+        for ( unsigned long i = 0; i < size; i++ ) {
+            value ^= (uint16_t) ( ( (const uint8_t*) buffer )[i] << 8 );
+            for ( int bit = 0; bit < 8; bit++ ) {
+                value = ( value & 0x8000 ) ? (uint16_t) ( ( value << 1 ) ^ polynomial ) :
+                                             (uint16_t) ( value << 1 );
+            }
+        }
+        *crc = value;
+        return 0;
+    }
+};
+
+} // namespace mbed
+
+namespace events {
+
+class EventQueue {
+public:
+    EventQueue( unsigned = 0, unsigned char* = nullptr ) {}
+
+    template <typename F, typename... Args>
+    int call( F function, Args... args )
+    {
+        return simTimerAdd( 0, 0, [=]() { function( args... ); } ) + 1;
+    }
+
+    template <typename Rep, typename Period, typename F, typename... Args>
+    int call_in( std::chrono::duration<Rep, Period> delay, F function, Args... args )
+    {
+        return simTimerAdd( mbed::simDurationUs( delay ), 0,
+                            [=]() { function( args... ); } ) + 1;
+    }
+
+    template <typename Rep, typename Period, typename F, typename... Args>
+    int call_every( std::chrono::duration<Rep, Period> period, F function, Args... args )
+    {
+        uint64_t periodUs = mbed::simDurationUs( period );
+        return simTimerAdd( periodUs, periodUs, [=]() { function( args... ); } ) + 1;
+    }
+
+    bool cancel( int id ) { simTimerCancel( id - 1 ); return true; }
+
+    // Todas las colas comparten la linea de tiempo del simulador
+    void dispatch_forever() { simMainLoopRun(); }
+};
+
+} // namespace events
+
+namespace rtos {
+
+class Thread {
+public:
+    Thread( osPriority = osPriorityNormal, uint32_t = 0, unsigned char* = nullptr,
+            const char* = nullptr ) {}
+    osStatus_t start( mbed::Callback<void()> ) { return 0; }
+};
+
+class Mutex {
+public:
+    void lock() {}
+    void unlock() {}
+    bool trylock() { return true; }
+};
+
+namespace ThisThread {
+inline osThreadId_t get_id() { return nullptr; }
+template <typename Rep, typename Period>
+void sleep_for( std::chrono::duration<Rep, Period> duration )
+{
+    simRunUntil( simTimeUs() + mbed::simDurationUs( duration ) );
+}
+} // namespace ThisThread
+
+namespace Kernel {
+struct Clock {
+    typedef std::chrono::milliseconds duration;
+    typedef std::chrono::time_point<Clock, duration> time_point;
+    static time_point now() { return time_point( duration( simTimeUs() / 1000 ) ); }
+};
+} // namespace Kernel
+
+} // namespace rtos
+
+// Los contadores de ciclos siguen al reloj virtual
+struct simCycleCounter_t {
+    operator uint32_t() const
+    {
+        return (uint32_t) ( simTimeUs() * ( SystemCoreClock / 1000000 ) );
+    }
+    simCycleCounter_t& operator=( uint32_t ) { return *this; }
+};
+
+struct simDwt_t {
+    uint32_t CTRL;
+    simCycleCounter_t CYCCNT;
+};
+
+struct simCoreDebug_t {
+    uint32_t DEMCR;
+};
+
+extern simDwt_t simDwt;
+extern simCoreDebug_t simCoreDebug;
+
+#define DWT                           ( &simDwt )
+#define CoreDebug                     ( &simCoreDebug )
+#define DWT_CTRL_CYCCNTENA_Msk        ( 1UL << 0 )
+#define CoreDebug_DEMCR_TRCENA_Msk    ( 1UL << 24 )
+
+using namespace mbed;
+using namespace events;
+using namespace rtos;
+
+//=====[Declarations (prototypes) of public functions]=========================
+
+inline bool UnbufferedSerial::readable()
+{
+    return simUartRxPending();
+}
+
+inline void core_util_critical_section_enter() {}
+inline void core_util_critical_section_exit() {}
+inline void __DMB() {}
+
+inline osStatus_t osThreadSetPriority( osThreadId_t, osPriority ) { return 0; }
+
+// Numero de pin en el puerto del NUCLEO_F429ZI, que en el STM32 es tambien
+// su linea EXTI: asi los modulos ven los mismos conflictos que en la placa
+inline int simStmPin( PinName pin )
+{
+    switch ( pin ) {
+    case BUTTON1: return 13;    // PC13
+    case D2:      return 15;    // PF15
+    case D4:      return 14;    // PF14
+    case D5:      return 11;    // PE11
+    case D6:      return 9;     // PE9
+    case D7:      return 13;    // PF13
+    case A0:      return 3;     // PA3
+    case A1:      return 0;     // PC0
+    case PE_12:   return 12;
+    case PE_10:   return 10;
+    case LED1:    return 0;     // PB0
+    case LED2:    return 7;     // PB7
+    case LED3:    return 14;    // PB14
+    case USBTX:   return 8;     // PD8
+    case USBRX:   return 9;     // PD9
+    default:      return -1;
+    }
+}
+#define STM_PIN( pin )    simStmPin( pin )
+
+inline void thread_sleep_for( uint32_t ms )
+{
+    simRunUntil( simTimeUs() + (uint64_t) ms * 1000 );
+}
+
+inline void analogin_init( analogin_t* adc, PinName pin ) { adc->pin = pin; }
+inline uint16_t analogin_read_u16( analogin_t* adc ) { return simAnalogRead( adc->pin ); }
+
+inline void gpio_init_in( gpio_t* gpio, PinName pin ) { gpio->pin = pin; }
+inline void gpio_init_in_ex( gpio_t* gpio, PinName pin, PinMode ) { gpio->pin = pin; }
+inline int gpio_read( gpio_t* gpio ) { return simPinRead( gpio->pin ); }
+
+inline int gpio_irq_init( gpio_irq_t* irq, PinName pin, gpio_irq_handler handler,
+                          uintptr_t context )
+{
+    irq->pin = pin;
+    irq->handler = handler;
+    irq->context = context;
+    return 0;
+}
+
+inline void gpio_irq_set( gpio_irq_t* irq, gpio_irq_event event, uint32_t enable )
+{
+    gpio_irq_handler handler = irq->handler;
+    uintptr_t context = irq->context;
+
+    if ( event == IRQ_NONE ) {
+        return;
+    }
+    if ( !enable ) {
+        simPinEdgeHandlerSet( irq->pin, event == IRQ_RISE, simHandler_t() );
+        return;
+    }
+    simPinEdgeHandlerSet( irq->pin, event == IRQ_RISE,
+                          [handler, context, event]() { handler( context, event ); } );
+}
+
+inline void gpio_irq_enable( gpio_irq_t* ) {}
+
+inline void mbed_stats_cpu_get( mbed_stats_cpu_t* stats )
+{
+    stats->uptime = simTimeUs();
+    stats->idle_time = 0;
+    stats->sleep_time = 0;
+    stats->deep_sleep_time = 0;
+}
+
+inline bool sleep_manager_can_deep_sleep() { return false; }
+
+//=====[#include guards - end]=================================================
+
+#endif // _SIM_MBED_H_
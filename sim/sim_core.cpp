@@ -0,0 +1,389 @@
+//=====[Libraries]=============================================================
+
+#include <queue>
+#include <vector>
+#include <deque>
+
+#include "mbed.h"
+#include "sim_core.h"
+
+//=====[Declaration of private data types]=====================================
+
+typedef struct {
+    simHandler_t handler;
+    uint64_t periodUs;          // 0: se dispara una sola vez
+    bool active;
+    uint32_t generation;        // Invalida los identificadores viejos al reusar
+} simTimer_t;
+
+typedef struct {
+    uint64_t timeUs;
+    uint64_t sequence;          // Desempata en orden de llegada
+    int timer;
+} simTimelineEntry_t;
+
+struct simTimelineLater {
+    bool operator()( const simTimelineEntry_t& a, const simTimelineEntry_t& b ) const
+    {
+        if ( a.timeUs != b.timeUs ) {
+            return a.timeUs > b.timeUs;
+        }
+        return a.sequence > b.sequence;
+    }
+};
+
+//=====[Declaration of private defines]========================================
+
+// Identificador de timer: indice en los 20 bits bajos y generacion arriba
+#define SIM_TIMER_INDEX_BITS        20
+#define SIM_TIMER_INDEX_MASK        ( ( 1 << SIM_TIMER_INDEX_BITS ) - 1 )
+#define SIM_TIMER_GENERATION_MASK   0x7FF
+
+#define SIM_FLASH_SIZE              0x200000
+
+//=====[Declaration and initialization of public global variables]=============
+
+uint32_t SystemCoreClock = 180000000;
+
+simDwt_t simDwt;
+simCoreDebug_t simCoreDebug;
+
+//=====[Declaration and initialization of private global variables]============
+
+static uint64_t simCurrentTimeUs = 0;
+static uint64_t simSequence = 0;
+static uint64_t simProcessedEvents = 0;
+
+static std::priority_queue<simTimelineEntry_t, std::vector<simTimelineEntry_t>,
+                           simTimelineLater> simTimeline;
+static std::vector<simTimer_t> simTimers;
+static std::vector<int> simFreeTimers;
+
+static simMainLoop_t simMainLoop = nullptr;
+
+static int simPinLevels[SIM_NUMBER_OF_PINS];
+static simHandler_t simPinRiseHandlers[SIM_NUMBER_OF_PINS];
+static simHandler_t simPinFallHandlers[SIM_NUMBER_OF_PINS];
+static simPinObserver_t simPinObserver = nullptr;
+static uint16_t simAnalogValues[SIM_NUMBER_OF_PINS];
+
+static std::vector<uint8_t> simFlash( SIM_FLASH_SIZE, 0xFF );
+
+static std::deque<char> simUartRxChars;
+static simHandler_t simUartRxHandler;
+static simHandler_t simUartTxHandler;
+static bool simUartTxScheduled = false;
+static simUartTxObserver_t simUartTxObserver = nullptr;
+
+static int simWatchdogTimer = -1;
+static uint64_t simWatchdogTimeoutUs = 0;
+static uint32_t simWatchdogExpirationCount = 0;
+
+static int simNetworkTimer = -1;
+static bool simNetworkLinkUp = false;
+static uint32_t simNetworkDatagramCount = 0;
+static uint32_t simNetworkByteCount = 0;
+
+//=====[Declarations (prototypes) of private functions]========================
+
+static void simTimelineInsert( uint64_t timeUs, int timer );
+static bool simPinValid( PinName pin );
+static void simUartTxKick();
+
+//=====[Implementations of public functions]===================================
+
+uint64_t simTimeUs()
+{
+    return simCurrentTimeUs;
+}
+
+int simTimerAdd( uint64_t delayUs, uint64_t periodUs, simHandler_t handler )
+{
+    int timer;
+
+    if ( !simFreeTimers.empty() ) {
+        timer = simFreeTimers.back();
+        simFreeTimers.pop_back();
+    } else {
+        timer = (int) simTimers.size();
+        simTimers.push_back( simTimer_t() );
+        simTimers[timer].generation = 0;
+    }
+
+    simTimers[timer].handler  = handler;
+    simTimers[timer].periodUs = periodUs;
+    simTimers[timer].active   = true;
+    simTimers[timer].generation = ( simTimers[timer].generation + 1 ) &
+                                  SIM_TIMER_GENERATION_MASK;
+    simTimelineInsert( simCurrentTimeUs + delayUs, timer );
+
+    return (int) ( simTimers[timer].generation << SIM_TIMER_INDEX_BITS ) | timer;
+}
+
+// La entrada queda en la linea de tiempo y se descarta al llegar su turno
+void simTimerCancel( int timer )
+{
+    int index = timer & SIM_TIMER_INDEX_MASK;
+    uint32_t generation = ( (uint32_t) timer >> SIM_TIMER_INDEX_BITS ) &
+                          SIM_TIMER_GENERATION_MASK;
+
+    if ( timer >= 0 && index < (int) simTimers.size() &&
+         simTimers[index].generation == generation ) {
+        simTimers[index].active = false;
+    }
+}
+
+void simRunUntil( uint64_t timeUs )
+{
+    while ( !simTimeline.empty() && simTimeline.top().timeUs <= timeUs ) {
+        simTimelineEntry_t entry = simTimeline.top();
+        simTimeline.pop();
+
+        simTimer_t* timer = &simTimers[entry.timer];
+        if ( !timer->active ) {
+            timer->handler = nullptr;
+            simFreeTimers.push_back( entry.timer );
+            continue;
+        }
+
+        simCurrentTimeUs = entry.timeUs;
+        simProcessedEvents++;
+
+        if ( timer->periodUs > 0 ) {
+            simTimelineInsert( entry.timeUs + timer->periodUs, entry.timer );
+            simHandler_t handler = timer->handler;
+            handler();
+        } else {
+            simHandler_t handler = timer->handler;
+            timer->active = false;
+            timer->handler = nullptr;
+            simFreeTimers.push_back( entry.timer );
+            handler();
+        }
+    }
+
+    if ( timeUs > simCurrentTimeUs ) {
+        simCurrentTimeUs = timeUs;
+    }
+}
+
+uint64_t simEventsProcessed()
+{
+    return simProcessedEvents;
+}
+
+void simMainLoopSet( simMainLoop_t mainLoop )
+{
+    simMainLoop = mainLoop;
+}
+
+void simMainLoopRun()
+{
+    if ( simMainLoop != nullptr ) {
+        simMainLoop();
+    }
+}
+
+void simPinWrite( PinName pin, int level )
+{
+    if ( !simPinValid( pin ) ) {
+        return;
+    }
+
+    int previousLevel = simPinLevels[pin];
+    simPinLevels[pin] = level ? 1 : 0;
+    if ( simPinLevels[pin] == previousLevel ) {
+        return;
+    }
+
+    if ( simPinObserver != nullptr ) {
+        simPinObserver( pin, simPinLevels[pin] );
+    }
+    if ( simPinLevels[pin] && simPinRiseHandlers[pin] ) {
+        simPinRiseHandlers[pin]();
+    }
+    if ( !simPinLevels[pin] && simPinFallHandlers[pin] ) {
+        simPinFallHandlers[pin]();
+    }
+}
+
+int simPinRead( PinName pin )
+{
+    return simPinValid( pin ) ? simPinLevels[pin] : 0;
+}
+
+void simPinEdgeHandlerSet( PinName pin, bool rising, simHandler_t handler )
+{
+    if ( !simPinValid( pin ) ) {
+        return;
+    }
+    if ( rising ) {
+        simPinRiseHandlers[pin] = handler;
+    } else {
+        simPinFallHandlers[pin] = handler;
+    }
+}
+
+void simPinObserverSet( simPinObserver_t observer )
+{
+    simPinObserver = observer;
+}
+
+uint8_t* simFlashMemory()
+{
+    return simFlash.data();
+}
+
+void simAnalogWrite( PinName pin, uint16_t value )
+{
+    if ( simPinValid( pin ) ) {
+        simAnalogValues[pin] = value;
+    }
+}
+
+uint16_t simAnalogRead( PinName pin )
+{
+    return simPinValid( pin ) ? simAnalogValues[pin] : 0;
+}
+
+// Los caracteres llegan todos juntos, como en una rafaga a la velocidad de
+// la UART; la interrupcion de RX se llama en el momento.
+void simUartRxWrite( const char* str )
+{
+    while ( *str != '\0' ) {
+        simUartRxChars.push_back( *str++ );
+    }
+    if ( simUartRxHandler ) {
+        simUartRxHandler();
+    }
+}
+
+bool simUartRxRead( char* receivedChar )
+{
+    if ( simUartRxChars.empty() ) {
+        return false;
+    }
+    *receivedChar = simUartRxChars.front();
+    simUartRxChars.pop_front();
+    return true;
+}
+
+bool simUartRxPending()
+{
+    return !simUartRxChars.empty();
+}
+
+void simUartRxHandlerSet( simHandler_t handler )
+{
+    simUartRxHandler = handler;
+}
+
+void simUartTxWrite( char transmittedChar )
+{
+    if ( simUartTxObserver != nullptr ) {
+        simUartTxObserver( transmittedChar );
+    }
+}
+
+// Mientras la interrupcion de TX este habilitada se la llama como si el
+// registro de datos estuviera siempre vacio.
+void simUartTxHandlerSet( simHandler_t handler )
+{
+    simUartTxHandler = handler;
+    simUartTxKick();
+}
+
+void simUartTxObserverSet( simUartTxObserver_t observer )
+{
+    simUartTxObserver = observer;
+}
+
+void simWatchdogStart( uint32_t timeoutMs )
+{
+    simWatchdogTimeoutUs = (uint64_t) timeoutMs * 1000;
+    simWatchdogKick();
+}
+
+void simWatchdogKick()
+{
+    if ( simWatchdogTimeoutUs == 0 ) {
+        return;
+    }
+    simTimerCancel( simWatchdogTimer );
+    simWatchdogTimer = simTimerAdd( simWatchdogTimeoutUs, simWatchdogTimeoutUs, []() {
+        simWatchdogExpirationCount++;
+    } );
+}
+
+uint32_t simWatchdogExpirations()
+{
+    return simWatchdogExpirationCount;
+}
+
+void simNetworkConnect()
+{
+    if ( simNetworkLinkUp || simNetworkTimer >= 0 ) {
+        return;
+    }
+    simNetworkTimer = simTimerAdd( (uint64_t) SIM_NETWORK_LINK_UP_MS * 1000, 0, []() {
+        simNetworkTimer = -1;
+        simNetworkLinkUp = true;
+    } );
+}
+
+void simNetworkDisconnect()
+{
+    simTimerCancel( simNetworkTimer );
+    simNetworkTimer = -1;
+    simNetworkLinkUp = false;
+}
+
+bool simNetworkUp()
+{
+    return simNetworkLinkUp;
+}
+
+void simNetworkDatagramWrite( const void* data, uint32_t length )
+{
+    simNetworkDatagramCount++;
+    simNetworkByteCount += length;
+}
+
+uint32_t simNetworkDatagrams()
+{
+    return simNetworkDatagramCount;
+}
+
+uint32_t simNetworkBytes()
+{
+    return simNetworkByteCount;
+}
+
+//=====[Implementations of private functions]==================================
+
+static void simTimelineInsert( uint64_t timeUs, int timer )
+{
+    simTimelineEntry_t entry = { timeUs, simSequence++, timer };
+    simTimeline.push( entry );
+}
+
+static bool simPinValid( PinName pin )
+{
+    return pin >= 0 && pin < SIM_NUMBER_OF_PINS;
+}
+
+static void simUartTxKick()
+{
+    if ( !simUartTxHandler || simUartTxScheduled ) {
+        return;
+    }
+    simUartTxScheduled = true;
+    simTimerAdd( 0, 0, []() {
+        simUartTxScheduled = false;
+        if ( simUartTxHandler ) {
+            simHandler_t handler = simUartTxHandler;
+            handler();
+            simUartTxKick();
+        }
+    } );
+}
@@ -0,0 +1,86 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _SIM_CORE_H_
+#define _SIM_CORE_H_
+
+//=====[Libraries]=============================================================
+
+#include <stdint.h>
+#include <functional>
+
+//=====[Declaration of public defines]=========================================
+
+#define SIM_NUMBER_OF_PINS    32
+
+//=====[Declaration of public data types]======================================
+
+// Solo los pines que usa el firmware
+typedef enum {
+    BUTTON1, D2, D4, D5, D6, D7,
+    A0, A1,
+    PE_12,              // Salida digital del MQ-2
+    PE_10,              // Sirena, open drain
+    LED1, LED2, LED3,
+    USBTX, USBRX,
+    NC = -1,
+} PinName;
+
+typedef std::function<void()> simHandler_t;
+typedef void (*simPinObserver_t)( PinName pin, int level );
+typedef void (*simUartTxObserver_t)( char transmittedChar );
+typedef void (*simMainLoop_t)();
+
+//=====[Declarations (prototypes) of public functions]=========================
+
+// Reloj virtual y linea de tiempo de eventos: cada interrupcion de Ticker o
+// Timeout y cada evento de una EventQueue es una entrada con su instante.
+uint64_t simTimeUs();
+int simTimerAdd( uint64_t delayUs, uint64_t periodUs, simHandler_t handler );
+void simTimerCancel( int timer );
+void simRunUntil( uint64_t timeUs );
+uint64_t simEventsProcessed();
+
+// EventQueue::dispatch_forever() del hilo main cede el control al simulador
+void simMainLoopSet( simMainLoop_t mainLoop );
+void simMainLoopRun();
+
+// Pines digitales: escribir un nivel dispara los flancos de InterruptIn
+void simPinWrite( PinName pin, int level );
+int simPinRead( PinName pin );
+void simPinEdgeHandlerSet( PinName pin, bool rising, simHandler_t handler );
+void simPinObserverSet( simPinObserver_t observer );
+
+// Contenido de la flash simulada, inicialmente borrada
+uint8_t* simFlashMemory();
+
+void simAnalogWrite( PinName pin, uint16_t value );
+uint16_t simAnalogRead( PinName pin );
+
+// Puerto serie de la consola
+void simUartRxWrite( const char* str );
+bool simUartRxRead( char* receivedChar );
+bool simUartRxPending();
+void simUartRxHandlerSet( simHandler_t handler );
+void simUartTxWrite( char transmittedChar );
+void simUartTxHandlerSet( simHandler_t handler );
+void simUartTxObserverSet( simUartTxObserver_t observer );
+
+// Watchdog: si no se alimenta durante el timeout cuenta una expiracion, que
+// en la placa seria un reset, y se vuelve a armar
+void simWatchdogStart( uint32_t timeoutMs );
+void simWatchdogKick();
+uint32_t simWatchdogExpirations();
+
+// Red: el enlace queda arriba SIM_NETWORK_LINK_UP_MS despues de conectar y
+// cada datagrama enviado solo se cuenta
+#define SIM_NETWORK_LINK_UP_MS    2000
+void simNetworkConnect();
+void simNetworkDisconnect();
+bool simNetworkUp();
+void simNetworkDatagramWrite( const void* data, uint32_t length );
+uint32_t simNetworkDatagrams();
+uint32_t simNetworkBytes();
+
+//=====[#include guards - end]=================================================
+
+#endif // _SIM_CORE_H_
@@ -0,0 +1,352 @@
+//=====[Libraries]=============================================================
+
+#include <vector>
+#include <algorithm>
+#include <chrono>
+
+#include "mbed.h"
+#include "alarm_config.h"
+
+//=====[Declaration of private defines]========================================
+
+#define SIM_ADC_FULL_SCALE               65535
+#define SIM_LM35_CENTI_DEGREES_FULL_SCALE 33000   // Mismo divisor que main.cpp
+#define SIM_OPERATOR_CHECK_PERIOD_MS       100
+#define SIM_DEFAULT_RESET_DELAY_MS        5000
+#define SIM_DEFAULT_TAIL_MS              10000
+#define SIM_DEFAULT_CODE                "1100"   // codeSequence de fabrica: A y B
+
+#define SIM_MS_TO_US( ms )    ( (uint64_t) ( ms ) * 1000 )
+
+//=====[Declaration of private data types]=====================================
+
+// Una linea de la traza: time_ms,temp_c,gas[,potentiometer[,hazard]]
+typedef struct {
+    uint64_t timeMs;
+    double tempC;
+    bool gas;
+    double potentiometer;       // 0.0 a 1.0
+    bool hazard;                // Verdad de referencia para las metricas
+} simTraceSample_t;
+
+// Texto que se escribe en la consola en un instante dado (opcion -c)
+typedef struct {
+    uint64_t timeMs;
+    const char* text;
+} simConsoleInput_t;
+
+typedef struct {
+    uint32_t hazardEpisodes;
+    uint32_t detections;
+    uint32_t missedDetections;
+    uint32_t falseAlarms;
+    uint32_t codeResets;
+    std::vector<uint64_t> latenciesMs;
+} simMetrics_t;
+
+//=====[Declarations (prototypes) of functions implemented in main.cpp]========
+
+int firmwareMain();
+
+//=====[Declaration and initialization of private global variables]============
+
+static std::vector<simTraceSample_t> simTrace;
+static uint64_t simTraceDurationMs = 0;
+static int simRepeat = 1;
+static uint64_t simResetDelayMs = SIM_DEFAULT_RESET_DELAY_MS;
+static uint64_t simTailMs = SIM_DEFAULT_TAIL_MS;
+static bool simVerbose = false;
+static std::vector<simConsoleInput_t> simConsoleInputs;
+
+static bool simHazardActive = false;
+static bool simHazardDetected = false;
+static uint64_t simHazardStartUs = 0;
+static uint64_t simHazardEndUs = 0;
+static bool simSirenOn = false;
+static uint64_t simLastCodeSentUs = 0;
+
+static simMetrics_t simMetrics;
+
+//=====[Declarations (prototypes) of private functions]========================
+
+static bool simTraceLoad( const char* fileName );
+static void simTraceSampleApply( const simTraceSample_t* sample );
+static void simHazardUpdate( bool hazard );
+static void simPinChanged( PinName pin, int level );
+static void simUartCharTransmitted( char transmittedChar );
+static void simOperatorUpdate();
+static void simRun();
+static void simReport( double wallTimeS );
+static void simUsage( const char* programName );
+
+//=====[Main function, the program entry point after power on or reset]========
+
+// Reproduce una traza de sensores sobre el firmware completo con un reloj
+// virtual y mide la latencia de deteccion y las falsas alarmas.
+//
+//   alarm_sim [-v] [-r repeticiones] [-d demora_reset_ms] [-c ms:texto] traza.csv
+int main( int argc, char** argv )
+{
+    const char* traceFileName = nullptr;
+    int i;
+
+    for ( i = 1; i < argc; i++ ) {
+        if ( strcmp( argv[i], "-v" ) == 0 ) {
+            simVerbose = true;
+        } else if ( strcmp( argv[i], "-r" ) == 0 && i + 1 < argc ) {
+            simRepeat = atoi( argv[++i] );
+        } else if ( strcmp( argv[i], "-d" ) == 0 && i + 1 < argc ) {
+            simResetDelayMs = strtoull( argv[++i], nullptr, 10 );
+        } else if ( strcmp( argv[i], "-c" ) == 0 && i + 1 < argc &&
+                    strchr( argv[i + 1], ':' ) != nullptr ) {
+            simConsoleInput_t input;
+            input.timeMs = strtoull( argv[++i], nullptr, 10 );
+            input.text = strchr( argv[i], ':' ) + 1;
+            simConsoleInputs.push_back( input );
+        } else if ( argv[i][0] != '-' && traceFileName == nullptr ) {
+            traceFileName = argv[i];
+        } else {
+            simUsage( argv[0] );
+            return 2;
+        }
+    }
+    if ( traceFileName == nullptr || simRepeat < 1 ) {
+        simUsage( argv[0] );
+        return 2;
+    }
+    if ( !simTraceLoad( traceFileName ) ) {
+        return 2;
+    }
+
+    // Reposo: sin gas (MQ-2 activo en bajo), botones sueltos
+    simPinWrite( PE_12, 1 );
+    simPinWrite( PE_10, 1 );
+    // Como en la placa, los sensores ya tienen su valor cuando el firmware
+    // arranca y carga los filtros
+    simTraceSampleApply( &simTrace.front() );
+    simPinObserverSet( simPinChanged );
+    simUartTxObserverSet( simUartCharTransmitted );
+    simMainLoopSet( simRun );
+
+    return firmwareMain();
+}
+
+//=====[Implementations of private functions]==================================
+
+static bool simTraceLoad( const char* fileName )
+{
+    FILE* file = fopen( fileName, "r" );
+    char line[256];
+    int lineNumber = 0;
+
+    if ( file == nullptr ) {
+        fprintf( stderr, "%s: cannot open trace\n", fileName );
+        return false;
+    }
+
+    while ( fgets( line, sizeof( line ), file ) != nullptr ) {
+        simTraceSample_t sample;
+        unsigned long long timeMs;
+        int gas;
+        int hazard = -1;
+        int fields;
+
+        lineNumber++;
+        if ( line[0] == '#' || line[0] == '\n' || line[0] == '\r' ) {
+            continue;
+        }
+
+        sample.potentiometer = 0.0;
+        fields = sscanf( line, "%llu,%lf,%d,%lf,%d", &timeMs, &sample.tempC, &gas,
+                         &sample.potentiometer, &hazard );
+        if ( fields < 3 ) {
+            fprintf( stderr, "%s:%d: expected time_ms,temp_c,gas[,potentiometer[,hazard]]\n",
+                     fileName, lineNumber );
+            fclose( file );
+            return false;
+        }
+        if ( !simTrace.empty() && timeMs < simTrace.back().timeMs ) {
+            fprintf( stderr, "%s:%d: time goes backwards\n", fileName, lineNumber );
+            fclose( file );
+            return false;
+        }
+
+        sample.timeMs = timeMs;
+        sample.gas = gas != 0;
+        // Sin columna hazard se toma como peligro lo mismo que deberia
+        // detectar la alarma, sin el retardo del filtro
+        sample.hazard = fields >= 5 ? hazard != 0 :
+                        sample.gas || sample.tempC > alarmConfig::overTempLevel;
+        simTrace.push_back( sample );
+    }
+    fclose( file );
+
+    if ( simTrace.empty() ) {
+        fprintf( stderr, "%s: empty trace\n", fileName );
+        return false;
+    }
+    simTraceDurationMs = simTrace.back().timeMs + 1;
+    return true;
+}
+
+static void simTraceSampleApply( const simTraceSample_t* sample )
+{
+    double lm35Reading = sample->tempC * 100.0 * SIM_ADC_FULL_SCALE /
+                         SIM_LM35_CENTI_DEGREES_FULL_SCALE;
+    double potentiometerReading = sample->potentiometer * SIM_ADC_FULL_SCALE;
+
+    lm35Reading = std::min( std::max( lm35Reading, 0.0 ), (double) SIM_ADC_FULL_SCALE );
+    potentiometerReading = std::min( std::max( potentiometerReading, 0.0 ),
+                                     (double) SIM_ADC_FULL_SCALE );
+
+    simAnalogWrite( A1, (uint16_t) ( lm35Reading + 0.5 ) );
+    simAnalogWrite( A0, (uint16_t) ( potentiometerReading + 0.5 ) );
+    simPinWrite( PE_12, sample->gas ? 0 : 1 );
+    simHazardUpdate( sample->hazard );
+}
+
+static void simHazardUpdate( bool hazard )
+{
+    if ( hazard == simHazardActive ) {
+        return;
+    }
+    simHazardActive = hazard;
+
+    if ( hazard ) {
+        simMetrics.hazardEpisodes++;
+        simHazardStartUs = simTimeUs();
+        simHazardDetected = simSirenOn;   // Ya sonando: no hay latencia que medir
+        if ( simSirenOn ) {
+            simMetrics.detections++;
+            simMetrics.latenciesMs.push_back( 0 );
+        }
+    } else {
+        simHazardEndUs = simTimeUs();
+        if ( !simHazardDetected ) {
+            simMetrics.missedDetections++;
+        }
+    }
+}
+
+// La sirena (PE_10, open drain) suena con el pin en bajo
+static void simPinChanged( PinName pin, int level )
+{
+    if ( pin != PE_10 ) {
+        return;
+    }
+
+    bool sirenOn = level == 0;
+    if ( sirenOn == simSirenOn ) {
+        return;
+    }
+    simSirenOn = sirenOn;
+    if ( !sirenOn ) {
+        return;
+    }
+
+    if ( simHazardActive ) {
+        if ( !simHazardDetected ) {
+            simHazardDetected = true;
+            simMetrics.detections++;
+            simMetrics.latenciesMs.push_back( ( simTimeUs() - simHazardStartUs ) / 1000 );
+        }
+    } else {
+        simMetrics.falseAlarms++;
+    }
+}
+
+static void simUartCharTransmitted( char transmittedChar )
+{
+    if ( simVerbose ) {
+        putchar( transmittedChar );
+    }
+}
+
+// Operador simulado: apaga la alarma por la consola con el codigo de fabrica
+// cuando el peligro lleva simResetDelayMs terminado.
+static void simOperatorUpdate()
+{
+    uint64_t nowUs = simTimeUs();
+
+    if ( !simSirenOn || simHazardActive ||
+         nowUs - simHazardEndUs < SIM_MS_TO_US( simResetDelayMs ) ||
+         nowUs - simLastCodeSentUs < SIM_MS_TO_US( simResetDelayMs ) ) {
+        return;
+    }
+
+    simLastCodeSentUs = nowUs;
+    simMetrics.codeResets++;
+    simUartRxWrite( "4" SIM_DEFAULT_CODE );
+}
+
+static void simRun()
+{
+    auto wallStart = std::chrono::steady_clock::now();
+    uint64_t offsetMs = 0;
+    int repetition;
+
+    simTimerAdd( SIM_MS_TO_US( SIM_OPERATOR_CHECK_PERIOD_MS ),
+                 SIM_MS_TO_US( SIM_OPERATOR_CHECK_PERIOD_MS ), simOperatorUpdate );
+    for ( const simConsoleInput_t& input : simConsoleInputs ) {
+        const char* text = input.text;
+        simTimerAdd( SIM_MS_TO_US( input.timeMs ), 0, [text]() { simUartRxWrite( text ); } );
+    }
+
+    for ( repetition = 0; repetition < simRepeat; repetition++ ) {
+        for ( const simTraceSample_t& sample : simTrace ) {
+            simRunUntil( SIM_MS_TO_US( offsetMs + sample.timeMs ) );
+            simTraceSampleApply( &sample );
+        }
+        offsetMs += simTraceDurationMs;
+    }
+    simRunUntil( SIM_MS_TO_US( offsetMs + simTailMs ) );
+
+    std::chrono::duration<double> wallTime = std::chrono::steady_clock::now() - wallStart;
+    simReport( wallTime.count() );
+
+    exit( simMetrics.missedDetections == 0 && simMetrics.falseAlarms == 0 ? 0 : 1 );
+}
+
+// Una linea clave=valor por metrica, facil de comparar entre corridas
+static void simReport( double wallTimeS )
+{
+    std::vector<uint64_t>& latencies = simMetrics.latenciesMs;
+    double simulatedS = simTimeUs() / 1e6;
+    uint64_t latencySum = 0;
+
+    std::sort( latencies.begin(), latencies.end() );
+    for ( uint64_t latency : latencies ) {
+        latencySum += latency;
+    }
+
+    printf( "\n" );
+    printf( "simulated_s=%.3f\n", simulatedS );
+    printf( "wall_s=%.3f\n", wallTimeS );
+    printf( "speedup=%.0f\n", wallTimeS > 0 ? simulatedS / wallTimeS : 0.0 );
+    printf( "events=%llu\n", (unsigned long long) simEventsProcessed() );
+    printf( "hazard_episodes=%u\n", simMetrics.hazardEpisodes );
+    printf( "detections=%u\n", simMetrics.detections );
+    printf( "missed_detections=%u\n", simMetrics.missedDetections );
+    printf( "false_alarms=%u\n", simMetrics.falseAlarms );
+    printf( "false_alarms_per_hour=%.3f\n",
+            simulatedS > 0 ? simMetrics.falseAlarms * 3600.0 / simulatedS : 0.0 );
+    printf( "code_resets=%u\n", simMetrics.codeResets );
+    printf( "watchdog_expirations=%u\n", simWatchdogExpirations() );
+    printf( "net_datagrams=%u\n", simNetworkDatagrams() );
+    printf( "net_bytes=%u\n", simNetworkBytes() );
+    if ( !latencies.empty() ) {
+        printf( "latency_min_ms=%llu\n", (unsigned long long) latencies.front() );
+        printf( "latency_avg_ms=%llu\n",
+                (unsigned long long) ( latencySum / latencies.size() ) );
+        printf( "latency_p95_ms=%llu\n",
+                (unsigned long long) latencies[( latencies.size() * 95 + 99 ) / 100 - 1] );
+        printf( "latency_max_ms=%llu\n", (unsigned long long) latencies.back() );
+    }
+}
+
+static void simUsage( const char* programName )
+{
+    fprintf( stderr, "usage: %s [-v] [-r repeat] [-d reset_delay_ms] [-c ms:text] trace.csv\n",
+             programName );
+    fprintf( stderr, "trace lines: time_ms,temp_c,gas[,potentiometer[,hazard]]\n" );
+}